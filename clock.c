@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "clock.h"
+#include "profiler.h"
 
 //Number of seconds elapsed since boot
 volatile uint32_t elapsedSeconds = 0;
@@ -12,9 +13,28 @@ volatile uint32_t elapsedSeconds = 0;
 #define CLOCK_LOCK_VALID_KEY    0xA5
 #define CLOCK_LOCK_INVALID_KEY  0xBB // Any key except the valid one
 
-// For the scheduler consumption:
+// For the scheduler consumption, driven by TA3 CCR1:
 static volatile bool clock_10ms_elapsed = false;
-static volatile uint16_t clock_internal_count_value = 40000u;        // 40k = 10ms
+static volatile uint32_t clock_tick_count_value = 0u;
+static uint8_t clock_tick_fraction = 0u;
+static uint32_t clock_now_value = 0u;
+
+// Clock profiles: DCO setting and FRAM wait states, over 8MHz the FRAM needs
+// one wait state (datasheet, table 5-3)
+struct ClockProfile
+{
+    uint8_t mhz;
+    uint16_t dco;               //CSCTL1
+    uint16_t waitStates;        //FRCTL0
+};
+
+static const struct ClockProfile clock_profiles[CLOCK_PROFILE_COUNT] =
+{
+    { 1, DCOFSEL_0,           NWAITS_0},
+    { 8, DCOFSEL_6,           NWAITS_0},
+    {16, DCORSEL | DCOFSEL_4, NWAITS_1},
+};
+static uint8_t clock_profile = CLOCK_PROFILE_DEFAULT;
 
 // For time sync between 10ms timer and XTAL:
 static volatile uint16_t clock_sync_measured_intosc_ticks = 0u;
@@ -109,14 +129,18 @@ void xtal_check(void)
 }
 
 /**
- * It sets Timer A3 to interrupt every 1s
+ * It sets Timer A3 to interrupt every 1s, and every 10ms on CCR1 for the
+ * scheduler tick
  */
 void millis_init(void)
 {
     // TACCR0 interrupt enabled
     TA3CCTL0 = CCIE;
-    //327.68 ~1ms
-    TA3CCR0 = 32768;
+    //32768 ticks of ACLK per period (0 to 32767) = 1s
+    TA3CCR0 = CLOCK_ACLK_TICKS_S - 1;
+    //First tick 10ms after the start, then moved by the ISR
+    TA3CCR1 = CLOCK_ACLK_TICKS_TICK;
+    TA3CCTL1 = CCIE;
     // ACLK, up mode
     TA3CTL = TASSEL__ACLK | MC__UP;
 
@@ -126,23 +150,178 @@ void millis_init(void)
 
 /**
  * It returns the elapsed time in millis since millis_init was called
- * (hopefully since the MCU booted up).
+ * (hopefully since the MCU booted up). It rolls over after 49 days, compare
+ * the values with MS_ELAPSED() and MS_AFTER().
+ */
+uint32_t millis_uptime(void)
+{
+    uint32_t seconds;
+    uint16_t millis;
+    return millis_uptime_split(&seconds, &millis);
+}
+
+/**
+ * Same as millis_uptime(), but it also gives the seconds (which never roll
+ * over) and the milliseconds within that second, all from the same reading
+ */
+uint32_t millis_uptime_split(uint32_t *seconds_out, uint16_t *millis_out)
+{
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    uint16_t x = clock_aclk_now();
+    uint32_t seconds = elapsedSeconds;
+    if(TA3CCTL0 & CCIFG)
+    {
+        //The second is over but its interrupt is not served yet
+        seconds++;
+        if(x >= CLOCK_ACLK_TICKS_S / 2)
+            x = 0;  //Read on CCR0 itself, just before the roll over
+    }
+    else if(x == CLOCK_ACLK_TICKS_S - 1)
+        x = 0;      //Interrupt already served on CCR0, it is the next second
+    __set_interrupt_state(interruptState);
+
+    uint16_t millis = (uint16_t)(((uint32_t)x * 1000UL) >> 15);
+    *seconds_out = seconds;
+    *millis_out = millis;
+    return seconds * 1000UL + millis;
+}
+
+/**
+ * millis_uptime() taken once at the start of the scheduler tick, for the
+ * tasks that only need to know the time of the tick
+ */
+uint32_t clock_now(void)
+{
+    return clock_now_value;
+}
+
+/**
+ * It takes the time of the tick, called by the scheduler
  */
-uint64_t millis_uptime(void)
+void clock_updateNow(void)
 {
-    //Wait until we manage to read the value accurately (read twice the register
-    //and it has the same number)
+    clock_now_value = millis_uptime();
+}
 
-    //Also avoid taking the value when x == 32768 because the elapsed seconds become
-    //unstable, maybe change before or after measuring x!!!
-    volatile uint32_t x = 0;
-    while (x != TA3R || x == 32768U || x == 32767U)
+/**
+ * It returns true once per scheduler tick (10ms), if it happened since the
+ * last call
+ */
+bool clock_tick_elapsed(void)
+{
+    if(!clock_10ms_elapsed)
+        return false;
+    clock_10ms_elapsed = false;
+    return true;
+}
+
+/**
+ * It returns true if a scheduler tick is waiting, without consuming it. To be
+ * checked with the interrupts disabled before going to sleep.
+ */
+bool clock_tick_pending(void)
+{
+    return clock_10ms_elapsed;
+}
+
+/**
+ * It returns the ACLK counter of TA3 (32768 per second), it keeps running
+ * in LPM0
+ */
+uint16_t clock_aclk_now(void)
+{
+    //Asynchronous to MCLK, read it until it is stable
+    volatile uint16_t x = TA3R;
+    while (x != TA3R)
         x = TA3R;
+    return x;
+}
+
+/**
+ * ACLK ticks since start (a value from clock_aclk_now()), up to 1s
+ */
+uint16_t clock_aclk_elapsed(uint16_t start)
+{
+    uint16_t now = clock_aclk_now();
+    if(now >= start)
+        return now - start;
+    return now + CLOCK_ACLK_TICKS_S - start;
+}
 
-    if (x > 32735U)
-        return ((uint64_t)elapsedSeconds * 1000UL + 999UL);
-    else
-        return ((uint64_t)elapsedSeconds * 1000UL + ((uint32_t) (x) * 1000UL / 32768UL));
+/**
+ * Number of scheduler ticks (10ms) since we booted up
+ */
+uint32_t clock_tick_count(void)
+{
+    //32 bits are not read in one instruction
+    uint32_t count;
+    do
+    {
+        count = clock_tick_count_value;
+    } while(count != clock_tick_count_value);
+    return count;
+}
+
+/**
+ * It changes the frequency of MCLK and SMCLK to the profile. The peripherals
+ * running on SMCLK are not touched, see clock_profile_set() for that.
+ * The wait states are raised before speeding up and lowered after slowing
+ * down, and the DCO is changed with MCLK divided by 4 so the transient of
+ * the DCO does not overclock the FRAM.
+ */
+int8_t clock_setProfile(uint8_t profile)
+{
+    if(profile >= CLOCK_PROFILE_COUNT)
+        return -1;
+    const struct ClockProfile *next = &clock_profiles[profile];
+
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+
+    if(next->waitStates > clock_profiles[clock_profile].waitStates)
+        FRCTL0 = FRCTLPW | next->waitStates;
+
+    CSCTL0_H = CSKEY_H;
+    CSCTL3 = DIVA__1 | DIVS__4 | DIVM__4;
+    CSCTL1 = next->dco;
+    //Let the DCO settle, about 10us
+    __delay_cycles(60);
+    CSCTL3 = DIVA__1 | DIVS__1 | DIVM__1;
+    CSCTL0_H = CLOCK_LOCK_INVALID_KEY;
+
+    if(next->waitStates < clock_profiles[clock_profile].waitStates)
+        FRCTL0 = FRCTLPW | next->waitStates;
+
+    clock_profile = profile;
+    __set_interrupt_state(interruptState);
+    return 0;
+}
+
+/**
+ * Current CLOCK_PROFILE_xxx
+ */
+uint8_t clock_getProfile(void)
+{
+    return clock_profile;
+}
+
+/**
+ * Current frequency of MCLK and SMCLK [MHz]
+ */
+uint8_t clock_getMHz(void)
+{
+    return clock_profiles[clock_profile].mhz;
+}
+
+/**
+ * Frequency of a profile [MHz], 0 if it does not exist
+ */
+uint8_t clock_profileMHz(uint8_t profile)
+{
+    if(profile >= CLOCK_PROFILE_COUNT)
+        return 0;
+    return clock_profiles[profile].mhz;
 }
 
 /**
@@ -158,11 +337,13 @@ uint32_t seconds_uptime(void)
  */
 void sleep_ms(const uint16_t ms)
 {
+    profiler_begin(PROFILER_SLEEP_MS);
     uint32_t timeStart = millis_uptime();
-    while(timeStart + ms > millis_uptime())
+    while(MS_ELAPSED(timeStart, millis_uptime()) < ms)
     {
         __no_operation();
     }
+    profiler_end(PROFILER_SLEEP_MS);
 }
 
 
@@ -177,4 +358,37 @@ __interrupt void TIMER_A3_ISR(void)
 }
 
 
+/**
+ * Scheduler tick every 10ms on CCR1. 32768 / 100 = 327.68 ACLK ticks, so the
+ * step is 328 on 68 ticks out of 100 and 327 on the rest: exactly 100 per
+ * second, locked to the seconds counter.
+ */
+#pragma vector=TIMER3_A1_VECTOR
+__interrupt void TIMER_A3_A1_ISR(void)
+{
+    switch(__even_in_range(TA3IV, TAIV__TAIFG))
+    {
+    case TAIV__TACCR1:
+    {
+        uint16_t next = TA3CCR1 + CLOCK_ACLK_TICKS_TICK;
+        clock_tick_fraction += 68u;
+        if(clock_tick_fraction >= 100u)
+        {
+            clock_tick_fraction -= 100u;
+            next++;
+        }
+        if(next >= CLOCK_ACLK_TICKS_S)
+            next -= CLOCK_ACLK_TICKS_S;
+        TA3CCR1 = next;
+        clock_tick_count_value++;
+        clock_10ms_elapsed = true;
+        //Wake up the scheduler
+        __bic_SR_register_on_exit(LPM0_bits);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 #endif /* __CLOCK_C__ */
@@ -10,15 +10,44 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// SMCLK frequency
+// SMCLK frequency at boot, see clock_getMHz() for the current one
 #define CLOCK_FREQ      8u                         // Timer clock frequency (MHz)
 
+// Clock profiles of MCLK = SMCLK, selected with clock_setProfile()
+#define CLOCK_PROFILE_1MHZ      0
+#define CLOCK_PROFILE_8MHZ      1
+#define CLOCK_PROFILE_16MHZ     2
+#define CLOCK_PROFILE_COUNT     3
+#define CLOCK_PROFILE_DEFAULT   CLOCK_PROFILE_8MHZ
+
 #define DELAY_US(X)  (__delay_cycles(X*CLOCK_FREQ))
 
+// Scheduler tick on TA3 (ACLK, 32768Hz)
+#define CLOCK_TICK_MS           10u
+#define CLOCK_ACLK_TICKS_S      32768u
+#define CLOCK_ACLK_TICKS_TICK   327u     // 327.68 per 10ms, see the ISR
+
+// Wrap-safe comparisons of millis_uptime() values, valid while they are less
+// than 24 days apart
+#define MS_ELAPSED(since, now)  ((uint32_t)((now) - (since)))
+#define MS_AFTER(a, b)          ((int32_t)((a) - (b)) > 0)
+
 //Public functions
 int8_t clock_init(void);
-uint64_t millis_uptime(void);
+uint32_t millis_uptime(void);
+uint32_t millis_uptime_split(uint32_t *seconds_out, uint16_t *millis_out);
+uint32_t clock_now(void);
+void clock_updateNow(void);
 uint32_t seconds_uptime(void);
 void sleep_ms(const uint16_t ms);
+bool clock_tick_elapsed(void);
+bool clock_tick_pending(void);
+uint16_t clock_aclk_now(void);
+uint16_t clock_aclk_elapsed(uint16_t start);
+uint32_t clock_tick_count(void);
+int8_t clock_setProfile(uint8_t profile);
+uint8_t clock_getProfile(void);
+uint8_t clock_getMHz(void);
+uint8_t clock_profileMHz(uint8_t profile);
 
 #endif
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "clock_profile.h"
+
+uint8_t clockLastTest_ = 0;         //CLOCK_TEST_xxx failed on the last change
+struct RDIDInfo clockNorId_;        //Read before the change, to compare after
+
+/**
+ * It changes the clock profile and sets again every peripheral running on
+ * SMCLK: UARTs, both I2C buses, SPI and the profiler timebase. Then it runs
+ * the self-test, if something fails it goes back to the default profile.
+ * Returns:
+ *  -1 if the profile does not exist
+ *  -2 if an open UART can not keep its baudrate with that clock
+ *  -3 if the self-test failed, see clock_profile_lastTest()
+ */
+int8_t clock_profile_set(uint8_t profile)
+{
+    if(profile >= CLOCK_PROFILE_COUNT)
+        return -1;
+
+    uint8_t i;
+    for(i = UART_DEBUG; i <= UART_CAM4; i++)
+    {
+        if(uart_isOpen(i) && !uart_baudrate_supported(profile, uart_get_baudrate(i)))
+            return -2;
+    }
+
+    uint8_t previousMHz = clock_getMHz();
+    spi_NOR_getRDID(&clockNorId_, confRegister_.nor_deviceSelected);
+
+    //Nothing must be half sent when the prescalers change
+    for(i = UART_DEBUG; i <= UART_CAM4; i++)
+    {
+        if(uart_isOpen(i))
+            uart_flush(i);
+    }
+
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    clock_setProfile(profile);
+    uart_retime();
+    i2c_retime();
+    spi_retime();
+    profiler_retime();
+    __set_interrupt_state(interruptState);
+
+    clockLastTest_ = clock_profile_selfTest();
+
+    uint8_t payload[5] = {0};
+    payload[0] = previousMHz;
+    payload[1] = clock_getMHz();
+    payload[2] = clockLastTest_;
+    payload[3] = clockLastTest_ != 0 && profile != CLOCK_PROFILE_DEFAULT;
+    saveEventSimple(EVENT_CLOCK_PROFILE, payload);
+
+    //Back to where everything is known to work
+    if(payload[3])
+        clock_profile_set(CLOCK_PROFILE_DEFAULT);
+
+    if(payload[2] != 0)
+        return -3;
+    return 0;
+}
+
+/**
+ * It checks the peripherals after a change of clock, returns the
+ * CLOCK_TEST_xxx that failed, 0 if everything is fine
+ */
+uint8_t clock_profile_selfTest(void)
+{
+    uint8_t failed = 0;
+
+    //SMCLK against the crystal: count the 1us timebase for 328 ticks of
+    //ACLK, starting just on an edge
+    uint16_t start = clock_aclk_now();
+    while(clock_aclk_now() == start);
+    start = clock_aclk_now();
+    uint32_t elapsed = profiler_now();
+    while(clock_aclk_elapsed(start) < CLOCK_TEST_ACLK_TICKS);
+    elapsed = profiler_now() - elapsed;
+    if(elapsed < CLOCK_TEST_US - CLOCK_TEST_TOLERANCE
+            || elapsed > CLOCK_TEST_US + CLOCK_TEST_TOLERANCE)
+        failed |= CLOCK_TEST_SMCLK;
+
+    uint8_t i;
+    for(i = UART_DEBUG; i <= UART_CAM4; i++)
+    {
+        if(uart_isOpen(i) && !uart_check_baudrate(i))
+            failed |= CLOCK_TEST_UART;
+    }
+
+    struct RTCDateTime dateTime;
+    if(i2c_RTC_getClockData(&dateTime) != 0)
+        failed |= CLOCK_TEST_I2C;
+
+    //The same ID as before the change, and not a floating bus
+    struct RDIDInfo norId;
+    spi_NOR_getRDID(&norId, confRegister_.nor_deviceSelected);
+    if(norId.manufacturerID == 0 || norId.manufacturerID == -1
+            || memcmp(&norId, &clockNorId_, sizeof(norId)) != 0)
+        failed |= CLOCK_TEST_SPI;
+
+    return failed;
+}
+
+/**
+ * CLOCK_TEST_xxx that failed on the last change of clock
+ */
+uint8_t clock_profile_lastTest(void)
+{
+    return clockLastTest_;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef CLOCK_PROFILE_H_
+#define CLOCK_PROFILE_H_
+
+#include <stdint.h>
+#include <msp430.h>
+#include "configuration.h"
+#include "clock.h"
+#include "uart.h"
+#include "i2c.h"
+#include "spi.h"
+#include "profiler.h"
+#include "datalogger.h"
+
+// Self-test after a change of clock, bits set on the failed checks
+#define CLOCK_TEST_SMCLK        0x01    // SMCLK against the 32kHz crystal
+#define CLOCK_TEST_UART         0x02    // Baudrate registers of the open ports
+#define CLOCK_TEST_I2C          0x04    // RTC read on the internal bus
+#define CLOCK_TEST_SPI          0x08    // RDID of the NOR memory
+
+#define CLOCK_TEST_ACLK_TICKS   328     // 10.01ms of ACLK
+#define CLOCK_TEST_US           10010   // [us] expected on the 1us timebase
+#define CLOCK_TEST_TOLERANCE    200     // [us] 2%, the DCO is +-1.5%
+
+int8_t clock_profile_set(uint8_t profile);
+uint8_t clock_profile_selfTest(void);
+uint8_t clock_profile_lastTest(void);
+
+#endif /* CLOCK_PROFILE_H_ */
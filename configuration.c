@@ -43,6 +43,44 @@ int8_t configuration_init(void)
         confRegister_.gopro_leds = 0;
         //1500ms is safer for bigger SD-Cards
         confRegister_.gopro_pictureSleep = 2500;
+        //Cameras switch on at least 2s apart, and while the battery current is under the limit
+        confRegister_.gopro_powerStagger = 2000;
+        confRegister_.gopro_currentLimit = 3000;
+        //Cameras stay on between pictures when it costs less than a power cycle
+        confRegister_.gopro_keepAlive = 1;
+        //Bursts of pictures, only on the flight states of the mask (bit 3 = TIMELAPSE)
+        confRegister_.gopro_burstCount = 3;
+        confRegister_.gopro_burstInterval = 2000;
+        confRegister_.gopro_burstStates = 0x00;
+        //Videos are split in 15 min files
+        confRegister_.gopro_videoSegment = 900;
+
+        //Video profiles: 0 = Black 2.7K 4:3 30fps, 1 = Silver 1440p 48fps,
+        //2 = High speed 960p 120fps, 3 = 1080p 30fps (less bitrate)
+        confRegister_.video_resolution[0] = 0x06;
+        confRegister_.video_resolution[1] = 0x07;
+        confRegister_.video_resolution[2] = 0x0A;
+        confRegister_.video_resolution[3] = 0x09;
+        confRegister_.video_fps[0] = 0x08;
+        confRegister_.video_fps[1] = 0x07;
+        confRegister_.video_fps[2] = 0x01;
+        confRegister_.video_fps[3] = 0x08;
+        confRegister_.video_fov[0] = 0x00;
+        confRegister_.video_fov[1] = 0x00;
+        confRegister_.video_fov[2] = 0x00;
+        confRegister_.video_fov[3] = 0x00;
+        confRegister_.video_exposure[0] = 0xFF;
+        confRegister_.video_exposure[1] = 0xFF;
+        confRegister_.video_exposure[2] = 0xFF;
+        confRegister_.video_exposure[3] = 0xFF;
+        //Profile of every camera (a nibble each) on every flight state
+        confRegister_.video_select[0] = 0x0000;
+        confRegister_.video_select[1] = 0x0000;
+        confRegister_.video_select[2] = 0x0000;
+        confRegister_.video_select[3] = 0x0000;
+        confRegister_.video_select[4] = 0x0000;
+        confRegister_.video_select[5] = 0x0000;
+        confRegister_.video_select[6] = 0x0000;
 
         //00 = Gopro Black, 01 = Gopro White
         confRegister_.gopro_model[0] = 00;
@@ -75,6 +113,15 @@ int8_t configuration_init(void)
 
         //Timelapse Configuration
         confRegister_.flight_timelapse_period = TIMELAPSE_PERIOD;
+        //Per camera period (0 = global) and phase, to interleave the cameras
+        confRegister_.flight_timelapse_camPeriod[0] = 0;
+        confRegister_.flight_timelapse_camPeriod[1] = 0;
+        confRegister_.flight_timelapse_camPeriod[2] = 0;
+        confRegister_.flight_timelapse_camPeriod[3] = 0;
+        confRegister_.flight_timelapse_camPhase[0] = 0;
+        confRegister_.flight_timelapse_camPhase[1] = 30;
+        confRegister_.flight_timelapse_camPhase[2] = 60;
+        confRegister_.flight_timelapse_camPhase[3] = 90;
         confRegister_.flight_camerasFirstLeg = 0x0F;    //Cameras 1, 2, 3 & 4
         confRegister_.flight_camerasSecondLeg = 0x0B;   //Cameras 1, 2 & 4
         confRegister_.flight_timeSecondLeg = 86400;     //24 hours
@@ -111,6 +158,9 @@ int8_t configuration_init(void)
         confRegister_.launch_videoDurationShort = 10;
         confRegister_.launch_timeClimbMaximum = 60;  //4hours (+ 2h of the launch video)
         confRegister_.flight_timelapse_period = 30;
+        confRegister_.flight_timelapse_camPhase[1] = 7;
+        confRegister_.flight_timelapse_camPhase[2] = 15;
+        confRegister_.flight_timelapse_camPhase[3] = 22;
         confRegister_.flight_timeSecondLeg = 120;
         confRegister_.landing_videoDurationLong = 20;
         confRegister_.landing_videoDurationShort = 10;
@@ -32,6 +32,14 @@
 #define FLIGHTSTATE_LANDING         4
 #define FLIGHTSTATE_TIMELAPSE_LAND  5
 #define FLIGHTSTATE_RECOVERY        6
+#define FLIGHTSTATE_COUNT           7
+
+//Video profiles, the first three are the ones the flight plan relies on
+#define VIDEO_PROFILES              4
+#define VIDEO_PROFILE_BLACK         0
+#define VIDEO_PROFILE_SILVER        1
+#define VIDEO_PROFILE_HIGHSPEED     2
+#define VIDEO_EXPOSURE_DEFAULT      0xFF
 
 //Define all the events that we want to store on the memories
 #define EVENT_BOOT                          69
@@ -48,6 +56,8 @@
 #define EVENT_CAMERA_VIDEO_INTERRUPT        18
 #define EVENT_CAMERA_SDCARD_FORMAT          19
 #define EVENT_STATE_CHANGED                 20
+#define EVENT_CAMERA_VIDEO_SEGMENT          21
+#define EVENT_CLOCK_PROFILE                 22
 #define EVENT_LOW_ALTITUDE_DETECTED         30
 #define EVENT_MOVEMENT_DETECTED             40
 #define EVENT_I2C_ERROR_RESET               99
@@ -85,6 +95,20 @@ struct ConfigurationRegister
     uint8_t gopro_leds;         //00 = off, 01 = 2, 02 = 4
     uint8_t gopro_model[4];     //00 = Gopro Black, 01 = Gopro White (TouchScreen)
     uint16_t gopro_pictureSleep; //2500 ms by default. less is too risky (depends on the sd-card)
+    uint16_t gopro_powerStagger;    //ms between camera power ups
+    uint16_t gopro_currentLimit;    //mA, 0 = no limit
+    uint8_t gopro_keepAlive;        //0 = never, 1 = auto, 2 = always
+    uint8_t gopro_burstCount;       //pictures per boot in burst states
+    uint16_t gopro_burstInterval;   //ms between burst pictures
+    uint8_t gopro_burstStates;      //bit N = flightState N
+    uint16_t gopro_videoSegment;    //s, 0 = one single clip
+
+    //Video profiles, and the one of every camera on each flight state
+    uint8_t video_resolution[VIDEO_PROFILES];   //CAM_VIDEO_RES_* code
+    uint8_t video_fps[VIDEO_PROFILES];          //CAM_VIDEO_FPS_* code
+    uint8_t video_fov[VIDEO_PROFILES];          //CAM_VIDEO_FOV_* code
+    uint8_t video_exposure[VIDEO_PROFILES];     //CAM_VIDEO_EXP_* code, 0xFF = default
+    uint16_t video_select[FLIGHTSTATE_COUNT];   //per flight state, a nibble per camera
 
 
     //Put here all the current execution status
@@ -98,8 +122,8 @@ struct ConfigurationRegister
     //States
     uint8_t flightState;
     uint8_t flightSubState;
-    uint64_t lastStateTime;
-    uint64_t lastSubStateTime;
+    uint32_t lastStateTime;
+    uint32_t lastSubStateTime;
 
     //Launch Configuration
     int32_t launch_heightThreshold;    //m
@@ -112,6 +136,8 @@ struct ConfigurationRegister
 
     //Timelapse Configuration
     uint16_t flight_timelapse_period;   //s
+    uint16_t flight_timelapse_camPeriod[4]; //s, 0 = flight_timelapse_period
+    uint16_t flight_timelapse_camPhase[4];  //s, first picture offset
     uint8_t  flight_camerasFirstLeg;
     uint8_t  flight_camerasSecondLeg;
     uint32_t flight_timeSecondLeg;      //s
@@ -9,11 +9,6 @@
 // GLOBAL VARIABLES
 
 // When was the last time each sensor was monitored?
-uint64_t lastTime_baroRead_ = 0;
-uint64_t lastTime_inaRead_ = 0;
-uint64_t lastTime_accRead_ = 0;
-uint64_t lastTime_tempRead_ = 0;
-uint64_t lastTime_gpioSunriseRead_ = 0;
 
 // How many times has a sensor been read per Telemetry Line? --> to compute avgs
 int16_t numTimes_baroRead_[2] = {0, 0};   // FRAM, NOR
@@ -32,6 +27,7 @@ struct AltitudesHistory
 struct AltitudesHistory altitudeHistory_[ALTITUDE_HISTORY];
 uint8_t altitudeHistoryIndex_ = 0;
 uint8_t baro_isOnError_ = 0;    //It signals if the barometer is not responding
+int16_t inaLastCurrent_ = 0;    //Last reading of the battery current, mA
 
 // PUBLIC FUNCTIONS
 
@@ -121,7 +117,7 @@ int32_t getVerticalSpeed()
     uint8_t minIndex = 9;
     uint8_t i;
 
-    uint64_t timeNow = millis_uptime();
+    uint32_t timeNow = millis_uptime();
 
     //Avoid calculating speeds if uptime is very low
     if(timeNow < ALTITUDE_HISTORY * 1500L)
@@ -201,6 +197,14 @@ int16_t getBatteryVoltage(uint8_t selection)
     return currentTelemetryLine_[1].voltage[selection];
 }
 
+/**
+ * It returns the last current read from the battery in mA, not averaged
+ */
+int16_t getBatteryCurrentNow()
+{
+    return inaLastCurrent_;
+}
+
 /**
  * It returns the status of the Barometer to see if it is on error status
  */
@@ -222,10 +226,10 @@ float accZAverages_[2];
  */
 void sensorsRead()
 {
-    uint64_t uptime_ms = millis_uptime();
+    uint32_t uptime_ms = clock_now();
 
     //Read GPIOs only once per second (like baro)
-    if(lastTime_gpioSunriseRead_ + confRegister_.baro_readPeriod < uptime_ms)
+    if(!timer_isRunning(TIMER_SENSOR_SUNRISE))
     {
         uint8_t gpioStatus = sunrise_GPIO_Read_RAW_no();
 
@@ -240,7 +244,7 @@ void sensorsRead()
             currentTelemetryLine_[1].switches_status &= ~BIT6;
         }
 
-        lastTime_gpioSunriseRead_ = uptime_ms;
+        timer_start(TIMER_SENSOR_SUNRISE, confRegister_.baro_readPeriod, 0);
     }
 
     //Add the rest of the thing of the switches:
@@ -336,7 +340,7 @@ void sensorsRead()
     currentTelemetryLine_[1].sub_state = confRegister_.flightSubState;
 
     //Time to read barometer?
-    if(lastTime_baroRead_ + confRegister_.baro_readPeriod < uptime_ms)
+    if(!timer_isRunning(TIMER_SENSOR_BARO))
     {
         //Try rebooting again the i2c and init the barometer if it was on error
         if(baro_isOnError_)
@@ -375,7 +379,7 @@ void sensorsRead()
             saveEventSimple(EVENT_I2C_ERROR_RESET, payload);
 
             //Reset time to read baro
-            lastTime_baroRead_ = uptime_ms;
+            timer_start(TIMER_SENSOR_BARO, confRegister_.baro_readPeriod, 0);
             return;
         }
 
@@ -445,11 +449,11 @@ void sensorsRead()
             numTimes_baroRead_[i]++;
         }
 
-        lastTime_baroRead_ = uptime_ms;
+        timer_start(TIMER_SENSOR_BARO, confRegister_.baro_readPeriod, 0);
     }
 
     //Time to read temperatures?
-    if(lastTime_tempRead_ + confRegister_.temp_readPeriod < uptime_ms)
+    if(!timer_isRunning(TIMER_SENSOR_TEMP))
     {
         int16_t temperatures[6];
         int8_t error = i2c_TMP75_getTemperatures(temperatures);
@@ -465,14 +469,15 @@ void sensorsRead()
             //currentTelemetryLineFRAMandNOR_[i].temperatures[4] = temperatures[4]; //External 03
         }
 
-        lastTime_tempRead_ = uptime_ms;
+        timer_start(TIMER_SENSOR_TEMP, confRegister_.temp_readPeriod, 0);
     }
 
     //Time to read voltages and currents?
-    if(lastTime_inaRead_ + confRegister_.ina_readPeriod < uptime_ms)
+    if(!timer_isRunning(TIMER_SENSOR_INA))
     {
         struct INAData inaData;
         int8_t error = i2c_INA_read(&inaData);
+        inaLastCurrent_ = inaData.current;
 
         if(inaData.current < 0)
         {
@@ -533,11 +538,11 @@ void sensorsRead()
             numTimes_inaRead_[i]++;
         }
 
-        lastTime_inaRead_ = uptime_ms;
+        timer_start(TIMER_SENSOR_INA, confRegister_.ina_readPeriod, 0);
     }
 
     //Time to read accelerations?
-    if(lastTime_accRead_ + confRegister_.acc_readPeriod < uptime_ms)
+    if(!timer_isRunning(TIMER_SENSOR_ACC))
     {
         struct ACCData accData;
         int8_t error = i2c_ADXL345_getAccelerations(&accData);
@@ -606,7 +611,7 @@ void sensorsRead()
 
             numTimes_accRead_[i]++;
         }
-        lastTime_accRead_ = uptime_ms;
+        timer_start(TIMER_SENSOR_ACC, confRegister_.acc_readPeriod, 0);
     }
 
 
@@ -656,8 +661,10 @@ int8_t saveEventSimple(uint8_t code, uint8_t payload[5])
 {
     //Register that a boot happened just now:
     struct EventLine newEvent = {0};
-    newEvent.upTime = (uint32_t) millis_uptime();
-    newEvent.unixTime = i2c_RTC_unixTime_now();
+    uint32_t elapsedSeconds;
+    uint16_t millis;
+    newEvent.upTime = millis_uptime_split(&elapsedSeconds, &millis);
+    newEvent.unixTime = i2c_RTC_unixTime_at(elapsedSeconds);
     newEvent.state = confRegister_.flightState;
     newEvent.sub_state = confRegister_.flightSubState;
     newEvent.event = code;
@@ -677,9 +684,10 @@ uint32_t lastTimeTelemetrySavedFRAM_ = 0;
  */
 int8_t saveTelemetry()
 {
-    uint64_t uptime = millis_uptime();
-    uint32_t elapsedSeconds = seconds_uptime();
-    uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
+    uint32_t elapsedSeconds;
+    uint16_t millis;
+    uint32_t uptime = millis_uptime_split(&elapsedSeconds, &millis);
+    uint32_t unixtTimeNow = i2c_RTC_unixTime_at(elapsedSeconds);
 
     //First save on the FRAM which is much faster
     //Save it only once every x seconds, otherwise we fill it!
@@ -939,19 +947,25 @@ int8_t getTelemetryNOR(uint32_t pointer,
 void printAltitudeHistory()
 {
     char strToPrint[200];
+    char *line;
     uart_print(UART_DEBUG, "Altitude History:\r\n");
     uint8_t i;
     for(i = 0; i < ALTITUDE_HISTORY; i++)
     {
-        sprintf(strToPrint, "  [%d]:\t%.3fs\t %.2fm\r\n",
-                i,
-                (float)altitudeHistory_[i].time / 1000.0,
-                (float)altitudeHistory_[i].altitude / 100.0);
-        uart_print(UART_DEBUG, strToPrint);
+        line = format_str(strToPrint, "  [");
+        line = format_uint(line, i, 1);
+        line = format_str(line, "]:\t");
+        line = format_fixed(line, altitudeHistory_[i].time, 3);
+        line = format_str(line, "s\t ");
+        line = format_fixed(line, altitudeHistory_[i].altitude, 2);
+        line = format_str(line, "m\r\n");
+        uart_write(UART_DEBUG, (uint8_t *)strToPrint, line - strToPrint);
     }
 
     int32_t speed = getVerticalSpeed();
-    sprintf(strToPrint, "Current Speed:   %.3fm/s\r\n", (float)speed / 100.0);
-    uart_print(UART_DEBUG, strToPrint);
+    line = format_str(strToPrint, "Current Speed:   ");
+    line = format_fixed(line, speed, 2);
+    line = format_str(line, "0m/s\r\n");
+    uart_write(UART_DEBUG, (uint8_t *)strToPrint, line - strToPrint);
 }
 
@@ -22,6 +22,8 @@
 #include "i2c_DS1338Z.h"
 #include "spi_NOR.h"
 #include "flight_signal.h"
+#include "format.h"
+#include "timers.h"
 
 #define MEMORY_NOR      0
 #define MEMORY_FRAM     1
@@ -65,6 +67,9 @@ struct TelemetryLine
     uint32_t unixTime;          // 4B - UNIX time [s]
     uint32_t upTime;            // 4B - Milliseconds since power on
                                 //      (it will roll over after 49 days)
+                                //      Taken at the same moment as unixTime,
+                                //      upTime % 1000 are its milliseconds
+                                //      until the first roll over
     int32_t pressure;           // 4B - Atmospheric pressure [mb * 100]
     int32_t altitude;           // 4B - Altitude [cm]
     int16_t verticalSpeed[3];   // 2B x 3 - Vertical Speed [cm/s]
@@ -133,6 +138,9 @@ struct EventLine
     uint32_t unixTime;          // 4B - UNIX time
     uint32_t upTime;            // 4B - Milliseconds since power on
                                 //      (it will roll over after 49 days)
+                                //      Taken at the same moment as unixTime,
+                                //      upTime % 1000 are its milliseconds
+                                //      until the first roll over
     uint8_t state;              // 1B - Actual Finite Machine State state
     uint8_t sub_state;          // 1B
     uint8_t event;              // 1B - Event code
@@ -170,5 +178,6 @@ int32_t getVerticalSpeed();
 int32_t getAltitude();
 uint8_t getBaroIsOnError();
 int16_t getBatteryVoltage(uint8_t selection);
+int16_t getBatteryCurrentNow();
 
 #endif /* DATALOGGER_H_ */
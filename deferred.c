@@ -0,0 +1,93 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "deferred.h"
+
+//Interrupts do not nest, so pushes never race with each other, the
+//scheduler is the only consumer
+static uint8_t deferredData_[DEFERRED_QUEUE_LENGTH * DEFERRED_ITEM_SIZE];
+static struct RingBuffer deferredQueue_ =
+        {deferredData_, DEFERRED_QUEUE_LENGTH * DEFERRED_ITEM_SIZE - 1, 0, 0};
+static volatile uint16_t deferredDropped_ = 0;
+static volatile uint8_t deferredMaxUsed_ = 0;
+static DeferredHandler deferredHandlers_[DEFERRED_TYPES] = {0};
+
+/**
+ * It queues work for the scheduler. It can be called from interrupts, or
+ * from the main loop. Returns -1 if the queue is full and the item is lost.
+ */
+int8_t deferred_push(uint8_t type, uint8_t data)
+{
+    uint8_t item[DEFERRED_ITEM_SIZE] = {type, data};
+    //Only one producer at a time, from the main loop too
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    if(ring_free(&deferredQueue_) < DEFERRED_ITEM_SIZE)
+    {
+        deferredDropped_++;
+        __set_interrupt_state(interruptState);
+        return -1;
+    }
+    //Both bytes are published at once
+    ring_write(&deferredQueue_, item, DEFERRED_ITEM_SIZE);
+    uint8_t used = ring_count(&deferredQueue_) / DEFERRED_ITEM_SIZE;
+    if(used > deferredMaxUsed_)
+        deferredMaxUsed_ = used;
+    __set_interrupt_state(interruptState);
+    return 0;
+}
+
+/**
+ * Function doing the work of a type, items without handler are discarded
+ */
+void deferred_setHandler(uint8_t type, DeferredHandler handler)
+{
+    if(type >= DEFERRED_TYPES)
+        return;
+    deferredHandlers_[type] = handler;
+}
+
+/**
+ * It does all the queued work, to be run by the scheduler. Consecutive items
+ * of the same type are given at once to the handler. Only what is queued
+ * now is done, work pushed meanwhile waits for the next call.
+ */
+void deferred_run(void)
+{
+    uint8_t data[DEFERRED_BATCH];
+    uint16_t count = ring_count(&deferredQueue_) / DEFERRED_ITEM_SIZE;
+    while(count != 0)
+    {
+        uint8_t type = ring_peek(&deferredQueue_, 0);
+        uint8_t length = 0;
+        while(count != 0 && ring_peek(&deferredQueue_, 0) == type
+                && length < DEFERRED_BATCH)
+        {
+            data[length++] = ring_peek(&deferredQueue_, 1);
+            //Free the slot before the handler, it may take a while
+            ring_skip(&deferredQueue_, DEFERRED_ITEM_SIZE);
+            count--;
+        }
+
+        if(type < DEFERRED_TYPES && deferredHandlers_[type] != 0)
+            deferredHandlers_[type](data, length);
+    }
+}
+
+/**
+ * Number of items lost because the queue was full
+ */
+uint16_t deferred_dropped(void)
+{
+    return deferredDropped_;
+}
+
+/**
+ * Highest number of items waiting on the queue since boot
+ */
+uint8_t deferred_maxUsed(void)
+{
+    return deferredMaxUsed_;
+}
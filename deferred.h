@@ -0,0 +1,35 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+#include <stdint.h>
+#include <msp430.h>
+#include "ringbuffer.h"
+
+// Work pushed by the interrupts and done later by the scheduler, so the
+// interrupts do the minimum and never print or wait on a peripheral
+#define DEFERRED_QUEUE_LENGTH   128     // Items, power of 2
+#define DEFERRED_BATCH          32      // Max items given to a handler at once
+
+// Types of work
+#define DEFERRED_UART_MIRROR    0       // Byte from a camera for the console
+#define DEFERRED_MOVEMENT       1       // Activity interrupt of the ADXL345
+#define DEFERRED_TYPES          2
+
+// Every item is 2 bytes on the ring: type and data
+#define DEFERRED_ITEM_SIZE      2
+
+// It receives the data of consecutive items of the same type
+typedef void (*DeferredHandler)(const uint8_t *data, uint8_t length);
+
+int8_t deferred_push(uint8_t type, uint8_t data);
+void deferred_setHandler(uint8_t type, DeferredHandler handler);
+void deferred_run(void);
+uint16_t deferred_dropped(void);
+uint8_t deferred_maxUsed(void);
+
+#endif /* DEFERRED_H_ */
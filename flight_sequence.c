@@ -8,7 +8,10 @@
 #define SUBSTATE_LANDING_VIDEO_STARTED         1
 #define SUBSTATE_LANDING_VIDEO_SHORTSSTARTED   2
 
-uint32_t lastTimePicture_ = 0;
+//Next picture of every camera in the timelapse, uptime in seconds
+uint32_t timelapseNextPicture_[4] = {0};
+uint32_t timelapseNextDeadline_ = 0;
+uint8_t  timelapseScheduled_ = 0;
 
 int32_t launchHeight_ = 0;
 uint8_t  launchDetectedFromSunrise_ = 0;
@@ -16,10 +19,85 @@ uint8_t  launchDetectedFromSunrise_ = 0;
 int32_t landingHeight_ = 0;
 uint8_t  landingDetectedFromSunrise_ = 0;
 
-uint64_t triggersLastTime_ = 0;
 uint16_t verticalSpeedTrigger_ = 0;
 uint16_t heightTrigger_ = 0;
 
+/**
+ * Returns the timelapse period of a camera, its own or the global one [s]
+ */
+uint32_t timelapsePeriod(uint8_t cameraNumber)
+{
+    uint32_t period = confRegister_.flight_timelapse_camPeriod[cameraNumber];
+    if(period == 0)
+        period = confRegister_.flight_timelapse_period;
+    if(period == 0)
+        period = 1;
+    return period;
+}
+
+/**
+ * Forces the timelapse to be scheduled again from the phase of every camera,
+ * to be used when its configuration changes
+ */
+void timelapseReschedule()
+{
+    timelapseScheduled_ = 0;
+}
+
+/**
+ * Takes a picture with the cameras of the mask that reached their deadline.
+ * Nothing is done until the closest deadline of all cameras arrives.
+ * Returns the mask of the cameras triggered
+ */
+uint8_t timelapseCheck(uint32_t uptime_s, uint8_t camerasMask)
+{
+    uint8_t i;
+
+    //First picture of every camera is delayed by its phase
+    if(timelapseScheduled_ == 0)
+    {
+        for(i = 0; i < 4; i++)
+            timelapseNextPicture_[i] = uptime_s
+                    + confRegister_.flight_timelapse_camPhase[i];
+        timelapseNextDeadline_ = uptime_s;
+        timelapseScheduled_ = 1;
+    }
+
+    if(uptime_s < timelapseNextDeadline_)
+        return 0;
+
+    uint8_t triggered = 0;
+    timelapseNextDeadline_ = 0xFFFFFFFF;
+    for(i = 0; i < 4; i++)
+    {
+        if(timelapseNextPicture_[i] <= uptime_s)
+        {
+            //If we are late (landing, long video...) do not try to catch up,
+            //skip the missed slots but keep the phase of the camera
+            uint32_t period = timelapsePeriod(i);
+            timelapseNextPicture_[i] += period
+                    * ((uptime_s - timelapseNextPicture_[i]) / period + 1);
+
+            //Cameras out of the mask just skip their slot, and are not
+            //kept on for nothing
+            if(camerasMask & (1 << i))
+            {
+                triggered |= (1 << i);
+                cameraSetNextPicture(i, timelapseNextPicture_[i] * 1000UL);
+            }
+            else
+                cameraKeepAliveRelease(i);
+        }
+        if(timelapseNextPicture_[i] < timelapseNextDeadline_)
+            timelapseNextDeadline_ = timelapseNextPicture_[i];
+    }
+
+    if(triggered != 0)
+        cameraBatchTakePicture(triggered);
+
+    return triggered;
+}
+
 /**
  * Checks if there are any activities to be performed during the flight
  */
@@ -29,7 +107,7 @@ void checkFlightSequence()
     if(confRegister_.flightState == FLIGHTSTATE_DEBUG)
         return;
 
-    uint64_t uptime_ms = millis_uptime();
+    uint32_t uptime_ms = clock_now();
 
     if(confRegister_.flightState == FLIGHTSTATE_WAITFORLAUNCH)
     {
@@ -42,9 +120,9 @@ void checkFlightSequence()
         uint8_t verticalSpeedReached = 0;
 
         //We count 10 times to see if threshold was achieved
-        if(triggersLastTime_ + 1000 < uptime_ms)
+        if(!timer_isRunning(TIMER_FLIGHT_TRIGGERS))
         {
-            triggersLastTime_ = uptime_ms;
+            timer_start(TIMER_FLIGHT_TRIGGERS, 1000, 0);
             int32_t altitude = getAltitude();
             if(altitude > (confRegister_.launch_heightThreshold * 100))
                 heightTrigger_++;
@@ -97,15 +175,15 @@ void checkFlightSequence()
             {
                 if((confRegister_.launch_camerasLong >> i) & 1)
                 {
-                    cameraMakeVideo(i,
-                                    CAMERAMODE_VID,
-                                    confRegister_.launch_videoDurationLong);
+                    cameraBatchMakeVideo(i,
+                                         CAMERAMODE_VID,
+                                         confRegister_.launch_videoDurationLong);
                 }
                 if((confRegister_.launch_camerasShort >> i) & 1)
                 {
-                    cameraMakeVideo(i,
-                                    CAMERAMODE_VID,
-                                    confRegister_.launch_videoDurationShort);
+                    cameraBatchMakeVideo(i,
+                                         CAMERAMODE_VID,
+                                         confRegister_.launch_videoDurationShort);
                 }
             }
 
@@ -130,10 +208,9 @@ void checkFlightSequence()
     if(confRegister_.flightState == FLIGHTSTATE_LAUNCH)
     {
         //Just wait for the duration of the longest video + 30s
-        if(confRegister_.lastStateTime
-                + (uint64_t)confRegister_.launch_videoDurationLong * 1000UL
-                + 30000
-                < uptime_ms)
+        if(MS_ELAPSED(confRegister_.lastStateTime, uptime_ms)
+                > (uint32_t)confRegister_.launch_videoDurationLong * 1000UL
+                + 30000)
         {
             uint8_t payload[5] = {0};
             payload[0] = FLIGHTSTATE_TIMELAPSE;
@@ -149,7 +226,7 @@ void checkFlightSequence()
         else
         {
             if(launchDetectedFromSunrise_
-                    && confRegister_.lastStateTime  + 600000L < uptime_ms)
+                    && MS_ELAPSED(confRegister_.lastStateTime, uptime_ms) > 600000L)
             {
                 int32_t currentAltitude = getAltitude();
                 if(currentAltitude - launchHeight_ < 10000L
@@ -182,39 +259,27 @@ void checkFlightSequence()
 
     if(confRegister_.flightState == FLIGHTSTATE_TIMELAPSE)
     {
-        uint32_t uptime_s = (uptime_ms / 1000UL);
-        //Is it time to make another picture?
-        if(lastTimePicture_ + (uint32_t)confRegister_.flight_timelapse_period < uptime_s)
-        {
-            uint8_t i;
-            uint8_t camerasIndex;
+        uint32_t uptime_s = seconds_uptime();
+        uint8_t camerasIndex;
 
-            //Decide on which cameras
-            if(uptime_s > (confRegister_.lastStateTime/1000UL + confRegister_.flight_timeSecondLeg))
-                camerasIndex =  confRegister_.flight_camerasSecondLeg;
-            else
-                camerasIndex =  confRegister_.flight_camerasFirstLeg;
-
-            for(i = 0; i < 4; i++)
-            {
-                //Switch on depending on when it is now:
-                if((camerasIndex >> i) & 1)
-                {
-                    cameraTakePicture(i);
-                }
-            }
+        //Decide on which cameras
+        if(MS_ELAPSED(confRegister_.lastStateTime, uptime_ms) / 1000UL
+                > confRegister_.flight_timeSecondLeg)
+            camerasIndex =  confRegister_.flight_camerasSecondLeg;
+        else
+            camerasIndex =  confRegister_.flight_camerasFirstLeg;
 
-            lastTimePicture_ = uptime_s;
-        }
+        //Every camera takes its picture on its own deadline
+        timelapseCheck(uptime_s, camerasIndex);
 
         uint8_t sunriseGpioSignal = sunrise_GPIO_Read_Signal();
         uint8_t heightReached = 0;
         uint8_t verticalSpeedReached = 0;
 
         //We count 10 times to see if threshold was achieved and once per second
-        if(triggersLastTime_ + 1000 < uptime_ms)
+        if(!timer_isRunning(TIMER_FLIGHT_TRIGGERS))
         {
-            triggersLastTime_ = uptime_ms;
+            timer_start(TIMER_FLIGHT_TRIGGERS, 1000, 0);
             int32_t altitude = getAltitude();
             int32_t verticalSpeed = getVerticalSpeed();
             if(altitude > confRegister_.landing_heightSecurityThreshold * 100)
@@ -249,9 +314,8 @@ void checkFlightSequence()
             || sunriseGpioSignal)
         {
             //Move only if safe descending time reached:
-            if(confRegister_.lastStateTime
-                    + (uint64_t)confRegister_.launch_timeClimbMaximum * 1000UL
-                    < uptime_ms)
+            if(MS_ELAPSED(confRegister_.lastStateTime, uptime_ms)
+                    > (uint32_t)confRegister_.launch_timeClimbMaximum * 1000UL)
             {
                 uint8_t payload[5] = {0};
                 payload[0] = FLIGHTSTATE_LANDING;
@@ -291,7 +355,7 @@ void checkFlightSequence()
 
     if(confRegister_.flightState == FLIGHTSTATE_LANDING)
     {
-        if(confRegister_.lastStateTime + 15000L > uptime_ms)
+        if(MS_ELAPSED(confRegister_.lastStateTime, uptime_ms) < 15000L)
         {
             //During the first 15s after changing, do not start this sequence
             //in order to avoid starting to take video while doing a picture
@@ -307,21 +371,21 @@ void checkFlightSequence()
             {
                 if((confRegister_.landing_camerasHighSpeed >> i) & 1)
                 {
-                    cameraMakeVideo(i,
-                                    CAMERAMODE_VID_HIGHSPEED,
-                                    confRegister_.landing_videoDurationShort);
+                    cameraBatchMakeVideo(i,
+                                         CAMERAMODE_VID_HIGHSPEED,
+                                         confRegister_.landing_videoDurationShort);
                 }
                 else if((confRegister_.landing_camerasLong >> i) & 1)
                 {
-                    cameraMakeVideo(i,
-                                    CAMERAMODE_VID,
-                                    confRegister_.landing_videoDurationLong);
+                    cameraBatchMakeVideo(i,
+                                         CAMERAMODE_VID,
+                                         confRegister_.landing_videoDurationLong);
                 }
                 else if((confRegister_.landing_camerasShort >> i) & 1)
                 {
-                    cameraMakeVideo(i,
-                                    CAMERAMODE_VID,
-                                    confRegister_.landing_videoDurationShort);
+                    cameraBatchMakeVideo(i,
+                                         CAMERAMODE_VID,
+                                         confRegister_.landing_videoDurationShort);
                 }
             }
 
@@ -346,14 +410,14 @@ void checkFlightSequence()
                 {
                     if((confRegister_.landing_camerasShort >> i) & 1)
                     {
-                        cameraMakeVideo(i,
-                                        CAMERAMODE_VID,
-                                        confRegister_.landing_videoDurationShort);
+                        cameraBatchMakeVideo(i,
+                                             CAMERAMODE_VID,
+                                             confRegister_.landing_videoDurationShort);
                     }else if((confRegister_.landing_camerasHighSpeed >> i) & 1)
                     {
-                        cameraMakeVideo(i,
-                                        CAMERAMODE_VID,
-                                        confRegister_.landing_videoDurationShort);
+                        cameraBatchMakeVideo(i,
+                                             CAMERAMODE_VID,
+                                             confRegister_.landing_videoDurationShort);
                     }
                 }
             }
@@ -361,10 +425,9 @@ void checkFlightSequence()
 
         //Lets wait for the duration of the long video plus 30 minutes to go
         //to next step
-        if(confRegister_.lastStateTime
-                + (uint64_t)confRegister_.landing_videoDurationLong * 1000UL
-                + 1800000UL
-                < uptime_ms)
+        if(MS_ELAPSED(confRegister_.lastStateTime, uptime_ms)
+                > (uint32_t)confRegister_.landing_videoDurationLong * 1000UL
+                + 1800000UL)
         {
             uint8_t payload[5] = {0};
             payload[0] = FLIGHTSTATE_TIMELAPSE_LAND;
@@ -383,7 +446,7 @@ void checkFlightSequence()
         else
         {
             if(landingDetectedFromSunrise_
-                    && confRegister_.lastStateTime  + 600000 < uptime_ms)
+                    && MS_ELAPSED(confRegister_.lastStateTime, uptime_ms) > 600000L)
             {
                 int32_t currentAltitude = getAltitude();
                 if(landingHeight_ - currentAltitude < 200000
@@ -412,20 +475,8 @@ void checkFlightSequence()
 
     if(confRegister_.flightState == FLIGHTSTATE_TIMELAPSE_LAND)
     {
-        uint32_t uptime_s = (uptime_ms / 1000UL);
-        //Is it time to make another picture?
-        if(lastTimePicture_ + (uint32_t)confRegister_.flight_timelapse_period < uptime_s)
-        {
-            uint8_t i;
-
-            for(i = 0; i < 4; i++)
-            {
-                //Switch on depending on when it is now:
-                cameraTakePicture(i);
-            }
-
-            lastTimePicture_ = uptime_s;
-        }
+        //All cameras, every one on its own deadline
+        timelapseCheck(seconds_uptime(), 0x0F);
 
         if(i2c_ADXL345_getMovementDetected() > 3) //More than 3 events in 1 minute
         {
@@ -443,9 +494,9 @@ void checkFlightSequence()
             uint8_t i;
             for(i = 0; i < 4; i++)
             {
-                cameraMakeVideo(i,
-                                CAMERAMODE_VID,
-                                confRegister_.recovery_videoDuration);
+                cameraBatchMakeVideo(i,
+                                     CAMERAMODE_VID,
+                                     confRegister_.recovery_videoDuration);
             }
         }
     }
@@ -453,20 +504,7 @@ void checkFlightSequence()
     if(confRegister_.flightState == FLIGHTSTATE_RECOVERY)
     {
         //Remain here for ever
-        uint32_t uptime_s = (uptime_ms / 1000UL);
-        //Is it time to make another picture?
-        if(lastTimePicture_
-                + (uint32_t)confRegister_.flight_timelapse_period < uptime_s)
-        {
-            uint8_t i;
-
-            for(i = 0; i < 4; i++)
-            {
-                //Switch on depending on when it is now:
-                cameraTakePicture(i);
-            }
-
-            lastTimePicture_ = uptime_s;
-        }
+        //All cameras, every one on its own deadline
+        timelapseCheck(seconds_uptime(), 0x0F);
     }
 }
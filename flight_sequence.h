@@ -15,5 +15,6 @@
 #include "datalogger.h"
 
 void checkFlightSequence();
+void timelapseReschedule();
 
 #endif /* FLIGHT_SEQUENCE_H_ */
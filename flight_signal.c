@@ -83,9 +83,9 @@ uint8_t checkFlightSignal()
         if(confRegister_.debugUART == 5)
         {
             char strToPrint[70];
-            uint64_t uptime = millis_uptime();
-            sprintf(strToPrint, "%.3fs: Sunrise activation signal detected!\r\n# ", uptime/1000.0);
-            uart_print(UART_DEBUG, strToPrint);
+            char *line = format_ufixed(strToPrint, (uint32_t)millis_uptime(), 3);
+            line = format_str(line, "s: Sunrise activation signal detected!\r\n# ");
+            uart_write(UART_DEBUG, (uint8_t *)strToPrint, line - strToPrint);
         }
     }
 
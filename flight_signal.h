@@ -11,6 +11,8 @@
 #include <msp430.h>
 #include "clock.h"
 #include "configuration.h"
+#include "uart.h"
+#include "format.h"
 
 // Constants
 #define TIME_BETWEEN_SIG    300     //[s] -> Time that has to pass after a signal ends
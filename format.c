@@ -0,0 +1,155 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ * The printf family on the MSP430 pulls the full library and takes thousands
+ * of cycles per line (there is no hardware divider). These functions only use
+ * subtractions of powers of ten, and produce the same output as the
+ * equivalent sprintf format, so CSV files do not change.
+ *
+ * The gain has not been measured on the hardware yet. With uartdebug 5, the
+ * memory read command prints its lines/s, run it on a build before and after
+ * this module to get the numbers.
+ */
+
+#include "format.h"
+
+static const uint32_t powersOfTen_[10] =
+{
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+static const char hexDigits_[16] =
+{
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/**
+ * Copies a null terminated string, without the null
+ */
+char *format_str(char *out, const char *str)
+{
+    while(*str != 0)
+        *out++ = *str++;
+    return out;
+}
+
+/**
+ * Just one character
+ */
+char *format_char(char *out, char character)
+{
+    *out++ = character;
+    return out;
+}
+
+/**
+ * Unsigned integer with at least "digits" digits padded with zeros, the same
+ * as "%.2lu" when digits is 2. 0 or 1 digits is just "%lu".
+ */
+char *format_uint(char *out, uint32_t value, uint8_t digits)
+{
+    uint8_t i;
+    uint8_t started = 0;
+    for(i = 0; i < 10; i++)
+    {
+        char digit = '0';
+        while(value >= powersOfTen_[i])
+        {
+            value -= powersOfTen_[i];
+            digit++;
+        }
+
+        if(digit != '0' || started || (10 - i) <= digits || i == 9)
+        {
+            *out++ = digit;
+            started = 1;
+        }
+    }
+    return out;
+}
+
+/**
+ * Signed integer, the same as "%.2ld" when digits is 2. 0 or 1 digits is
+ * just "%ld"
+ */
+char *format_int(char *out, int32_t value, uint8_t digits)
+{
+    if(value < 0)
+    {
+        *out++ = '-';
+        return format_uint(out, (uint32_t)(-(value + 1)) + 1, digits);
+    }
+    return format_uint(out, (uint32_t)value, digits);
+}
+
+/**
+ * Uppercase hexadecimal with exactly "digits" digits (up to 8), the same as
+ * "%02X" when digits is 2. Digits above are not printed, so use enough!
+ */
+char *format_hex(char *out, uint32_t value, uint8_t digits)
+{
+    if(digits > 8)
+        digits = 8;
+    while(digits > 0)
+    {
+        digits--;
+        *out++ = hexDigits_[(value >> (digits * 4)) & 0x0F];
+    }
+    return out;
+}
+
+/**
+ * Fixed point decimal. The value is already scaled by 10^decimals, so
+ * format_fixed(out, 12345, 2) writes "123.45". It gives the same result as
+ * printf("%.2f", 12345/100.0) without using floats.
+ */
+char *format_fixed(char *out, int32_t value, uint8_t decimals)
+{
+    if(value < 0)
+    {
+        *out++ = '-';
+        return format_ufixed(out, (uint32_t)(-(value + 1)) + 1, decimals);
+    }
+    return format_ufixed(out, (uint32_t)value, decimals);
+}
+
+/**
+ * The same as format_fixed() for unsigned values
+ */
+char *format_ufixed(char *out, uint32_t value, uint8_t decimals)
+{
+    if(decimals == 0)
+        return format_uint(out, value, 1);
+    if(decimals > 9)
+        decimals = 9;
+
+    //Split integer and decimal parts
+    uint32_t scale = powersOfTen_[9 - decimals];
+    uint32_t integer = 0;
+    while(value >= scale)
+    {
+        //Subtract in big steps first to be fast with big numbers
+        uint8_t i;
+        for(i = 0; i < 10 - decimals; i++)
+            if(value >= powersOfTen_[i] && powersOfTen_[i] >= scale)
+                break;
+        value -= powersOfTen_[i];
+        integer += powersOfTen_[i + decimals];
+    }
+
+    out = format_uint(out, integer, 1);
+    *out++ = '.';
+    return format_uint(out, value, decimals);
+}
+
+/**
+ * Null terminates the string
+ */
+char *format_end(char *out)
+{
+    *out = 0;
+    return out;
+}
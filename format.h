@@ -0,0 +1,28 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+
+//******************************************************************************
+//* PUBLIC FUNCTION DECLARATIONS :                                             *
+//******************************************************************************
+// Small replacements for sprintf on the hot paths of the terminal. All of them
+// write on "out" and return the pointer to the next free character, so they
+// can be chained to compose a full line. The string is NOT null terminated,
+// use format_end() for that.
+char *format_str(char *out, const char *str);
+char *format_char(char *out, char character);
+char *format_uint(char *out, uint32_t value, uint8_t digits);
+char *format_int(char *out, int32_t value, uint8_t digits);
+char *format_hex(char *out, uint32_t value, uint8_t digits);
+char *format_fixed(char *out, int32_t value, uint8_t decimals);
+char *format_ufixed(char *out, uint32_t value, uint8_t decimals);
+char *format_end(char *out);
+
+#endif /* FORMAT_H_ */
@@ -10,6 +10,30 @@ struct CameraStatus cameraStatus_[4] = {0};
 uint8_t cameraHasStarted_[4] = {0};
 uint8_t cameraMode_[4] = {CAMERAMODE_PIC};
 char strToPrint_[50];
+struct CameraQueue cameraQueue_[4] = {0};
+//Commands built at run time, the queue only keeps a pointer to them
+char cameraDateTimeCmd_[4][100];
+char videoProfileCmd_[VIDEO_PROFILES][24];
+char videoProfileExpCmd_[VIDEO_PROFILES][16];
+volatile struct CameraStatusPin cameraStatusPin_[4] = {0};
+struct CameraBatchRequest cameraBatch_[4] = {0};
+uint32_t cameraBatchLastPowerOn_ = 0;
+uint32_t cameraBatchWaitingSince_ = 0;
+struct CameraEnergy cameraEnergy_[4] = {0};
+
+/*
+ * It prints a debug trace like "12.345s: Camera 1 [message]" on the console
+ */
+void cameraDebugTrace(uint8_t selectedCamera, char *message)
+{
+    char *line = strToPrint_;
+    line = format_ufixed(line, (uint32_t)millis_uptime(), 3);
+    line = format_str(line, "s: Camera ");
+    line = format_uint(line, selectedCamera + 1, 1);
+    line = format_char(line, ' ');
+    uart_write(UART_DEBUG, (uint8_t *)strToPrint_, line - strToPrint_);
+    uart_print(UART_DEBUG, message);
+}
 
 /*
  * Begins an UART communication with the selected camera.
@@ -22,11 +46,192 @@ int8_t gopros_raw_cameraInit(uint8_t selectedCamera, uint8_t cameraMode)
         uart_init(selectedCamera + 1, BR_57600);
         cameraHasStarted_[selectedCamera] = 1;
         cameraMode_[selectedCamera] = cameraMode;
+        mewpro_init(selectedCamera);
     //}
 
     return 0;
 }
 
+/**
+ * It builds the commands of every video profile (resolution, fps and field of
+ * view, and exposure). To be called every time the profiles are changed.
+ */
+void cameraVideoProfilesBuild()
+{
+    uint8_t i;
+    for(i = 0; i < VIDEO_PROFILES; i++)
+    {
+        char *line = videoProfileCmd_[i];
+        line = format_str(line, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
+        line = format_hex(line, confRegister_.video_resolution[i], 2);
+        line = format_hex(line, confRegister_.video_fps[i], 2);
+        line = format_hex(line, confRegister_.video_fov[i], 2);
+        line = format_char(line, '\n');
+        format_end(line);
+
+        line = videoProfileExpCmd_[i];
+        if(confRegister_.video_exposure[i] != VIDEO_EXPOSURE_DEFAULT)
+        {
+            line = format_str(line, CAM_PAYLOAD_VIDEO_EXP);
+            line = format_hex(line, confRegister_.video_exposure[i], 2);
+            line = format_char(line, '\n');
+        }
+        format_end(line);
+    }
+}
+
+/*
+ * Returns the video profile of the camera for the current flight state
+ */
+uint8_t cameraVideoProfile(uint8_t selectedCamera, uint8_t cameraMode)
+{
+    if(cameraMode == CAMERAMODE_VID_HIGHSPEED)
+        return VIDEO_PROFILE_HIGHSPEED;
+
+    uint8_t profile = VIDEO_PROFILE_BLACK;
+    if(confRegister_.flightState < FLIGHTSTATE_COUNT)
+        profile = (confRegister_.video_select[confRegister_.flightState]
+                >> (4 * selectedCamera)) & 0x0F;
+    if(profile >= VIDEO_PROFILES)
+        profile = VIDEO_PROFILE_BLACK;
+
+    //GOPRO Hero4 Silver is less capable unfortunately
+    if(profile == VIDEO_PROFILE_BLACK && confRegister_.gopro_model[selectedCamera] != 0)
+        profile = VIDEO_PROFILE_SILVER;
+    return profile;
+}
+
+/**
+ * Adds a command to the queue of the camera. The string must stay valid until
+ * it is sent. Returns -1 if the queue is full.
+ */
+int8_t cameraQueueAdd(uint8_t selectedCamera, const char *command,
+                      uint16_t delayAfter, uint8_t expectReply)
+{
+    struct CameraQueue *queue = &cameraQueue_[selectedCamera];
+    if(queue->length >= CAM_QUEUE_LENGTH)
+        return -1;
+    queue->commands[queue->length].command = command;
+    queue->commands[queue->length].delayAfter = delayAfter;
+    queue->commands[queue->length].expectReply = expectReply;
+    queue->length++;
+    return 0;
+}
+
+/**
+ * It drops everything pending on the queue of the camera
+ */
+void cameraQueueClear(uint8_t selectedCamera)
+{
+    cameraQueue_[selectedCamera].length = 0;
+    cameraQueue_[selectedCamera].next = 0;
+    cameraQueue_[selectedCamera].waiting = 0;
+}
+
+/**
+ * Returns 1 when all the commands have been sent and their delays are over
+ */
+uint8_t cameraQueueIsEmpty(uint8_t selectedCamera)
+{
+    return cameraQueue_[selectedCamera].waiting == 0
+            && cameraQueue_[selectedCamera].next >= cameraQueue_[selectedCamera].length;
+}
+
+/*
+ * It sends the next command of the queue of the camera when its time has
+ * come. It never blocks, so it is called on every pass of the FSM.
+ */
+void cameraQueueCheck(uint8_t selectedCamera, uint32_t uptime)
+{
+    struct CameraQueue *queue = &cameraQueue_[selectedCamera];
+    if(queue->waiting)
+    {
+        struct CameraCommand *last = &queue->commands[queue->next - 1];
+        uint32_t start = queue->sentTime;
+        if(last->command != NULL)
+        {
+            //The delay starts once the command has left the UART
+            if(uart_tx_isDrained(selectedCamera + 1))
+            {
+                if(MS_AFTER(uart_tx_drainedAt(selectedCamera + 1), start))
+                    start = uart_tx_drainedAt(selectedCamera + 1);
+            }
+            else if(MS_ELAPSED(queue->sentTime, uptime) <= CAM_WAIT_TX_DRAINED)
+                return;
+        }
+        uint8_t answered = last->expectReply
+                && mewpro_getResult(selectedCamera) != MEWPRO_NONE;
+        if(!answered && !MS_AFTER(uptime, start + last->delayAfter))
+            return;
+        queue->waiting = 0;
+    }
+
+    if(queue->next >= queue->length)
+    {
+        //Nothing else to send, let the other camera use the mux if shared
+        if(queue->length != 0)
+            uart_mux_release(selectedCamera + 1);
+        queue->next = 0;
+        queue->length = 0;
+        return;
+    }
+
+    struct CameraCommand *command = &queue->commands[queue->next];
+    if(command->command != NULL)
+    {
+        //CAM3 and CAM4 share the UART: wait for our slot, and keep it until
+        //the answer has had time to arrive
+        if(!uart_mux_request(selectedCamera + 1, command->delayAfter + UART_MUX_HOLD))
+            return;
+        uart_print(selectedCamera + 1, (char *)command->command);
+        mewpro_expect(selectedCamera, command->command);
+    }
+    queue->next++;
+    queue->sentTime = uptime;
+    queue->waiting = 1;
+}
+
+/*
+ * It queues the commands to set video mode with the given profile
+ */
+int8_t cameraQueueVideoProfile(uint8_t selectedCamera, uint8_t profile,
+                               uint16_t delayAfterMode)
+{
+    int8_t error = 0;
+    error += cameraQueueAdd(selectedCamera, CAM_SET_VIDEO_MODE, delayAfterMode, 0);
+    if(videoProfileExpCmd_[profile][0] != '\0')
+    {
+        error += cameraQueueAdd(selectedCamera, videoProfileCmd_[profile], 50, 0);
+        error += cameraQueueAdd(selectedCamera, videoProfileExpCmd_[profile], 0, 0);
+    }
+    else
+        error += cameraQueueAdd(selectedCamera, videoProfileCmd_[profile], 0, 0);
+    return error;
+}
+
+/*
+ * It queues the mode commands of the configuration after boot
+ */
+void cameraQueueModeConfiguration(uint8_t selectedCamera)
+{
+    if(cameraMode_[selectedCamera] == CAMERAMODE_VID
+            || cameraMode_[selectedCamera] == CAMERAMODE_VID_HIGHSPEED)
+    {
+        //Configure video with the profile of this flight state
+        uint8_t profile = cameraVideoProfile(selectedCamera, cameraMode_[selectedCamera]);
+        cameraQueueVideoProfile(selectedCamera, profile, 200);
+    }
+    else if(cameraMode_[selectedCamera] == CAMERAMODE_PIC)
+    {
+        //Configure picture: easypeasy
+        if(cameraStatus_[selectedCamera].slowMode)
+            cameraQueueAdd(selectedCamera, CAM_SET_PHOTO_MODE, 200, 0);
+        else
+            cameraQueueAdd(selectedCamera, CAM_SET_PHOTO_MODE, 100, 0);
+        cameraQueueAdd(selectedCamera, CAM_PHOTO_RES_12MP_WIDE, 0, 0);
+    }
+}
+
 /**
  * It sets the camera in Picture Mode
  */
@@ -35,7 +240,7 @@ int8_t gopros_raw_cameraSetPictureMode(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, CAM_SET_PHOTO_MODE);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, CAM_SET_PHOTO_MODE);
     return 0;
 }
 
@@ -47,38 +252,10 @@ int8_t gopros_raw_cameraSetVideoMode(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
 
-    if(confRegister_.gopro_model[selectedCamera] == 0)
-    {
-        uart_print(selectedCamera + 1, CAM_SET_VIDEO_MODE);
-        uart_flush(selectedCamera + 1);
-        sleep_ms(50);
-
-        //GOPRO Hero4 Black
-        uart_print(selectedCamera + 1, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
-        uart_print(selectedCamera + 1, CAM_VIDEO_RES_2_7K_4_3);
-        uart_print(selectedCamera + 1, CAM_VIDEO_FPS_30);
-        uart_print(selectedCamera + 1, CAM_VIDEO_FOV_WIDE);
-        //uart_print(selectedCamera + 1, CAM_VIDEO_RES_720);
-        //uart_print(selectedCamera + 1, CAM_VIDEO_FPS_30);
-        //uart_print(selectedCamera + 1, CAM_VIDEO_FOV_NARROW);
-        uart_print(selectedCamera + 1, "\n");
-        uart_flush(selectedCamera + 1);
-        //TODO
-    }
-    else
-    {
-        uart_print(selectedCamera + 1, CAM_SET_VIDEO_MODE);
-        uart_flush(selectedCamera + 1);
-        sleep_ms(50);
-
-        //GOPRO Hero4 Silver is less capable unfortunately
-        uart_print(selectedCamera + 1, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
-        uart_print(selectedCamera + 1, CAM_VIDEO_RES_1440);
-        uart_print(selectedCamera + 1, CAM_VIDEO_FPS_48);
-        uart_print(selectedCamera + 1, CAM_VIDEO_FOV_WIDE);
-        uart_print(selectedCamera + 1, "\n");
-        uart_flush(selectedCamera + 1);
-    }
+    //Sent by the FSM, 50ms apart
+    uint8_t profile = cameraVideoProfile(selectedCamera, CAMERAMODE_VID);
+    if(cameraQueueVideoProfile(selectedCamera, profile, 50) != 0)
+        return -2;
 
     return 0;
 }
@@ -91,12 +268,10 @@ int8_t gopros_raw_cameraTakePicture(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, CAM_PHOTO_TAKE_PIC);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, CAM_PHOTO_TAKE_PIC);
     if(confRegister_.debugUART == 5)
     {
-        uint64_t uptime = millis_uptime();
-        sprintf(strToPrint_, "%.3fs: Camera %d picture command.\r\n# ", uptime/1000.0, selectedCamera+1);
-        uart_print(UART_DEBUG, strToPrint_);
+        cameraDebugTrace(selectedCamera, "picture command.\r\n# ");
     }
     return 0;
 }
@@ -110,7 +285,7 @@ int8_t gopros_raw_cameraStartRecordingVideo(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, CAM_VIDEO_START_REC);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, CAM_VIDEO_START_REC);
     return 0;
 }
 
@@ -122,7 +297,7 @@ int8_t gopros_raw_cameraStopRecordingVideo(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, CAM_VIDEO_STOP_REC);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, CAM_VIDEO_STOP_REC);
     return 0;
 }
 
@@ -134,7 +309,7 @@ int8_t gopros_raw_cameraFormatSDCard(uint8_t selectedCamera)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, CAM_FORMAT_SDCARD);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, CAM_FORMAT_SDCARD);
     return 0;
 }
 
@@ -146,7 +321,7 @@ int8_t gopros_raw_cameraRawSendCommand(uint8_t selectedCamera, char * cmd)
     if (!cameraHasStarted_[selectedCamera])
         return -1;
     uart_print(selectedCamera + 1, cmd);
-    uart_flush(selectedCamera + 1);
+    mewpro_expect(selectedCamera, cmd);
     return 0;
 }
 
@@ -211,6 +386,7 @@ void cutPower(uint8_t camera)
     //We need to close the UART otherwise we are losing power through
     //the opened UART port to the MewPro
     uart_close(camera + 1);
+    cameraQueueClear(camera);
     switch(camera)
     {
     case CAMERA01:
@@ -230,6 +406,229 @@ void cutPower(uint8_t camera)
     cameraHasStarted_[camera] = 0;
 }
 
+/**
+ * It configures the POWERCAMxx_STATUS pins (P4.0, P4.1, P4.2 and P5.7) as
+ * inputs with an interrupt on the next edge
+ */
+void cameraStatusPinsInit()
+{
+    P4DIR &= ~(BIT0 | BIT1 | BIT2);
+    P5DIR &= ~BIT7;
+
+    cameraStatusPin_[CAMERA01].level = (P4IN & BIT0) != 0;
+    cameraStatusPin_[CAMERA02].level = (P4IN & BIT1) != 0;
+    cameraStatusPin_[CAMERA03].level = (P4IN & BIT2) != 0;
+    cameraStatusPin_[CAMERA04].level = (P5IN & BIT7) != 0;
+
+    //Wait for the opposite edge: high to low if it is high now
+    P4IES = (P4IES & ~(BIT0 | BIT1 | BIT2)) | (P4IN & (BIT0 | BIT1 | BIT2));
+    P5IES = (P5IES & ~BIT7) | (P5IN & BIT7);
+
+    P4IFG &= ~(BIT0 | BIT1 | BIT2);
+    P5IFG &= ~BIT7;
+    P4IE |= BIT0 | BIT1 | BIT2;
+    P5IE |= BIT7;
+}
+
+/**
+ * Returns 1 if the status pin of the camera says it is switched on
+ */
+uint8_t cameraStatusPinIsOn(uint8_t selectedCamera)
+{
+    return cameraStatusPin_[selectedCamera].level == CAM_STATUS_PIN_ON;
+}
+
+/*
+ * Returns 1 if the status pin has changed, since the current step started,
+ * to the level the step is waiting for
+ */
+uint8_t cameraStatusPinReached(uint8_t selectedCamera)
+{
+    if(!cameraStatusPin_[selectedCamera].edge)
+        return 0;
+    switch(cameraStatus_[selectedCamera].fsmStatus)
+    {
+    case FSM_CAM_POWERON_WAIT:
+    case FSM_CAM_PRESSBTN_WAIT:
+        return cameraStatusPinIsOn(selectedCamera);
+    case FSM_CAM_POWEROFF_WAIT:
+        return !cameraStatusPinIsOn(selectedCamera);
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Current of the other cameras as given by their model, or -1 if any of them
+ * is booting, shooting, recording or switching off and it is unknown.
+ */
+int16_t cameraEnergyOthers(uint8_t selectedCamera)
+{
+    int16_t current = 0;
+    uint8_t i;
+    for(i = 0; i < 4; i++)
+    {
+        if(i == selectedCamera)
+            continue;
+        if(cameraStatus_[i].fsmStatusGlobal == FSMGLOBAL_CAM_PICTUREIDLE
+                && cameraStatus_[i].fsmStatus == FSM_CAM_DONOTHING)
+            current += cameraEnergy_[i].modelIdleCurrent != 0 ?
+                    cameraEnergy_[i].modelIdleCurrent : CAM_DEF_IDLE_CURRENT;
+        else if(cameraStatus_[i].cameraStatus != CAM_STATUS_OFF
+                || cameraStatus_[i].fsmStatus != FSM_CAM_DONOTHING)
+            return -1;
+    }
+    return current;
+}
+
+/*
+ * Closes the measure going on, updating the model, and starts the new one
+ */
+void cameraEnergyPhase(uint8_t selectedCamera, uint8_t phase, uint32_t uptime)
+{
+    struct CameraEnergy *energy = &cameraEnergy_[selectedCamera];
+    if(energy->phase == CAM_ENERGY_IDLE
+            && energy->idleValid && energy->idleTime > 0)
+    {
+        int32_t idleCurrent = energy->idleCharge / (int32_t)energy->idleTime;
+        //The first measure replaces the default, then it is filtered
+        if(idleCurrent > 0 && energy->modelIdleCurrent == 0)
+            energy->modelIdleCurrent = idleCurrent;
+        else if(idleCurrent > 0)
+            energy->modelIdleCurrent = (3 * (uint32_t)energy->modelIdleCurrent
+                    + (uint32_t)idleCurrent) / 4;
+    }
+    else if(energy->phase == CAM_ENERGY_OFF
+            && energy->cycleValid && energy->cycleCharge > 0)
+    {
+        if(energy->modelCycleCharge == 0)
+            energy->modelCycleCharge = energy->cycleCharge;
+        else
+            energy->modelCycleCharge = (3 * energy->modelCycleCharge
+                    + (uint32_t)energy->cycleCharge) / 4;
+    }
+
+    if(phase == CAM_ENERGY_BOOT)
+    {
+        int16_t others = cameraEnergyOthers(selectedCamera);
+        energy->baseline = getBatteryCurrentNow() - others;
+        energy->cycleCharge = 0;
+        energy->cycleValid = others >= 0;
+    }
+    else if(phase == CAM_ENERGY_IDLE)
+    {
+        energy->idleCharge = 0;
+        energy->idleTime = 0;
+        energy->idleValid = 1;
+    }
+    energy->phase = phase;
+    energy->lastSample = uptime;
+}
+
+/*
+ * Integrates the battery current of every camera being measured
+ */
+void cameraEnergyCheck(uint32_t uptime)
+{
+    int16_t current = getBatteryCurrentNow();
+    uint8_t i;
+    for(i = 0; i < 4; i++)
+    {
+        struct CameraEnergy *energy = &cameraEnergy_[i];
+        if(energy->phase == CAM_ENERGY_NONE)
+            continue;
+
+        uint32_t elapsed = MS_ELAPSED(energy->lastSample, uptime);
+        energy->lastSample = uptime;
+        int16_t others = cameraEnergyOthers(i);
+        int32_t charge = ((int32_t)current - energy->baseline - others)
+                * (int32_t)elapsed;
+
+        if(energy->phase == CAM_ENERGY_IDLE)
+        {
+            if(others < 0)
+                energy->idleValid = 0;
+            energy->idleCharge += charge;
+            energy->idleTime += elapsed;
+            //Long idles are closed every hour so the charge does not overflow
+            if(energy->idleTime > 3600000UL)
+                cameraEnergyPhase(i, CAM_ENERGY_IDLE, uptime);
+        }
+        else
+        {
+            if(others < 0)
+                energy->cycleValid = 0;
+            energy->cycleCharge += charge;
+        }
+    }
+}
+
+/*
+ * It decides if the camera stays on in picture mode until its next picture
+ * instead of doing a whole power cycle: it does if being idle until then
+ * costs less than a boot and a power off.
+ */
+uint8_t cameraKeepAliveDecide(uint8_t selectedCamera, uint32_t uptime_ms)
+{
+    if(confRegister_.gopro_keepAlive == CAM_KEEPALIVE_NEVER)
+        return 0;
+
+    //Nobody told us when the next picture is
+    if(cameraStatus_[selectedCamera].nextPictureTime == 0
+            || !MS_AFTER(cameraStatus_[selectedCamera].nextPictureTime, uptime_ms))
+        return 0;
+
+    int16_t batteryVoltage = getBatteryVoltage(0);
+    if(batteryVoltage > 0 && batteryVoltage < 675)
+        return 0;
+
+    if(confRegister_.gopro_keepAlive == CAM_KEEPALIVE_ALWAYS)
+        return 1;
+
+    uint32_t cycleCharge = cameraEnergy_[selectedCamera].modelCycleCharge;
+    if(cycleCharge == 0)
+        cycleCharge = CAM_DEF_CYCLE_CHARGE;
+    uint16_t idleCurrent = cameraEnergy_[selectedCamera].modelIdleCurrent;
+    if(idleCurrent == 0)
+        idleCurrent = CAM_DEF_IDLE_CURRENT;
+
+    uint64_t idleCharge = (uint64_t)idleCurrent
+            * MS_ELAPSED(uptime_ms, cameraStatus_[selectedCamera].nextPictureTime);
+    return idleCharge < cycleCharge;
+}
+
+/*
+ * Number of pictures to take on every timelapse boot: a burst on the flight
+ * states selected by gopro_burstStates, a single one otherwise
+ */
+uint8_t cameraBurstCount()
+{
+    if(confRegister_.flightState < 8
+            && (confRegister_.gopro_burstStates & (1 << confRegister_.flightState))
+            && confRegister_.gopro_burstCount > 1)
+        return confRegister_.gopro_burstCount;
+    return 1;
+}
+
+/*
+ * Returns 1 while the camera is on its way to be switched off
+ */
+uint8_t cameraIsSwitchingOff(uint8_t selectedCamera)
+{
+    if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_OFF)
+        return 1;
+
+    switch(cameraStatus_[selectedCamera].fsmStatus)
+    {
+    case FSM_CAM_PRESSBTNOFF:
+    case FSM_CAM_PRESSBTNOFF_WAIT:
+    case FSM_CAM_POWEROFF_WAIT:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
 /**
  * Stars the Power On sequence
  */
@@ -259,13 +658,16 @@ int8_t cameraPowerOn(uint8_t selectedCamera, uint8_t slowMode)
         break;
     }
     //Start FSM
+    cameraStatusPin_[selectedCamera].edge = 0;
     cameraStatus_[selectedCamera].fsmStatus = FSM_CAM_POWERON_WAIT;
-    cameraStatus_[selectedCamera].lastCommandTime = millis_uptime();
+    cameraStatus_[selectedCamera].lastCommandTime = clock_now();
+    cameraEnergyPhase(selectedCamera, CAM_ENERGY_BOOT,
+                      cameraStatus_[selectedCamera].lastCommandTime);
 
     if(cameraStatus_[selectedCamera].slowMode)
-        cameraStatus_[selectedCamera].sleepTime = 2500;
+        timer_start(TIMER_CAM_STEP + selectedCamera, 2500, 0);
     else
-        cameraStatus_[selectedCamera].sleepTime = 1500;
+        timer_start(TIMER_CAM_STEP + selectedCamera, 1500, 0);
 
     return 0;
 }
@@ -279,15 +681,19 @@ int8_t cameraPowerOff(uint8_t selectedCamera)
     if(cameraStatus_[selectedCamera].cameraStatus == CAM_STATUS_OFF)
         error = -1;  //Return error
 
-    //Send the command to power off
+    //Nothing else must be sent after the power off
+    cameraQueueClear(selectedCamera);
+
+    //Send the command to power off, the button is pressed by the FSM once it
+    //has been completely sent
     uart_print(selectedCamera + 1, CAM_POWEROFF);
-    uart_flush(selectedCamera + 1);
 
+    cameraStatusPin_[selectedCamera].edge = 0;
     cameraStatus_[selectedCamera].fsmStatus = FSM_CAM_PRESSBTNOFF;
-    pressButton(selectedCamera);
-    cameraStatus_[selectedCamera].fsmStatus = FSM_CAM_PRESSBTNOFF_WAIT;
-    cameraStatus_[selectedCamera].lastCommandTime = millis_uptime();
-    cameraStatus_[selectedCamera].sleepTime = CAM_WAIT_BUTTON /*+ 1000*/;
+    cameraStatus_[selectedCamera].lastCommandTime = clock_now();
+    timer_start(TIMER_CAM_STEP + selectedCamera, 0, 0);
+    cameraEnergyPhase(selectedCamera, CAM_ENERGY_OFF,
+                      cameraStatus_[selectedCamera].lastCommandTime);
     return error;
 }
 
@@ -299,24 +705,8 @@ int8_t cameraPowerOffUnsafe(uint8_t selectedCamera)
     cutPower(selectedCamera);
     cameraStatus_[selectedCamera].fsmStatus = FSM_CAM_DONOTHING;
     cameraStatus_[selectedCamera].cameraStatus = CAM_STATUS_OFF;
-    return 0;
-}
-
-/**
- * It searches a particular flag in order to tell if the camera successfully booted up
- */
-int8_t searchInUart(uint8_t uartIndex, uint8_t flag)
-{
-    uint16_t nchars = uart_available(uartIndex + 1);
-    if(nchars < 1)
-        return 0;
-    uint16_t i;
-    for(i = 0; i < nchars; i++)
-    {
-        //Search the flag
-        if(uart_read(uartIndex + 1) == flag)
-            return 1;
-    }
+    //The power cycle was not complete, do not learn from it
+    cameraEnergy_[selectedCamera].phase = CAM_ENERGY_NONE;
     return 0;
 }
 
@@ -325,79 +715,104 @@ int8_t searchInUart(uint8_t uartIndex, uint8_t flag)
  */
 int8_t cameraFSMlowLevelCheck()
 {
-    uint64_t uptime = millis_uptime();
+    uint32_t uptime = clock_now();
     uint8_t i;
+    //Give the shared UART of CAM3/CAM4 to the one that has been waiting
+    uart_mux_service();
     for(i = 0; i < 4; i++)
     {
+        //Consume everything the MewPro has answered
+        uint8_t reply = mewpro_parse(i);
+        if(reply == MEWPRO_ERROR && confRegister_.debugUART == 5)
+        {
+            cameraDebugTrace(i, "answered with error.\r\n# ");
+        }
+        //Send whatever is due on its command queue
+        cameraQueueCheck(i, uptime);
         if(cameraStatus_[i].fsmStatus == FSM_CAM_DONOTHING)
         {
-            //Flush anything that is on the UART:
-            searchInUart(i, 0);
             //Camera is fine like it is :)
             continue;
         }
-        if(cameraStatus_[i].lastCommandTime + cameraStatus_[i].sleepTime < uptime)
+        //While booting, keep the shared UART of CAM3/CAM4 listening, the '@'
+        //is lost if the mux points to the other camera
+        if(cameraStatus_[i].fsmStatus == FSM_CAM_CONF_1 && !mewpro_hasBooted(i))
+            uart_mux_request(i + 1, UART_MUX_HOLD);
+        //The status pin moves the FSM as soon as the camera switches, the
+        //sleep time is kept as timeout
+        uint8_t statusReached = cameraStatusPinReached(i);
+        if(statusReached
+                || !timer_isRunning(TIMER_CAM_STEP + i))
         {
             //Move to next step!
             switch(cameraStatus_[i].fsmStatus)
             {
             case FSM_CAM_POWERON_WAIT:
-                pressButton(i);
-                cameraStatus_[i].fsmStatus = FSM_CAM_PRESSBTN_WAIT;
-                cameraStatus_[i].lastCommandTime = uptime;
-                cameraStatus_[i].sleepTime = CAM_WAIT_BUTTON;
-                if(confRegister_.debugUART == 5)
+                //The power is up, press the button without waiting more
+                if(!statusReached || !CAM_STATUS_PIN_IS_CAMERA)
                 {
-                    uint64_t uptime = millis_uptime();
-                    sprintf(strToPrint_, "%.3fs: Camera %d Start pressing button.\r\n# ", uptime/1000.0, i+1);
-                    uart_print(UART_DEBUG, strToPrint_);
+                    pressButton(i);
+                    cameraStatusPin_[i].edge = 0;
+                    cameraStatus_[i].fsmStatus = FSM_CAM_PRESSBTN_WAIT;
+                    cameraStatus_[i].lastCommandTime = uptime;
+                    timer_start(TIMER_CAM_STEP + i, CAM_WAIT_BUTTON, 0);
+                    if(confRegister_.debugUART == 5)
+                    {
+                        cameraDebugTrace(i, "Start pressing button.\r\n# ");
+                    }
+                    break;
                 }
-                break;
+                //It switched on by itself, pressing the button would
+                //switch it off, so go on as if it had been pressed. Only
+                //with CAM_STATUS_PIN_IS_CAMERA
+                //no break
             case FSM_CAM_PRESSBTN_WAIT:
                 releaseButton(i);
                 cameraStatus_[i].fsmStatus = FSM_CAM_CONF_1;
                 cameraStatus_[i].lastCommandTime = uptime;
                 //cameraStatus_[i].sleepTime = /*CAM_WAIT_POWER*/ 2500;
                 if(cameraStatus_[i].slowMode)
-                    cameraStatus_[i].sleepTime = 4000;
+                    timer_start(TIMER_CAM_STEP + i, 4000, 0);
                 else
-                    cameraStatus_[i].sleepTime = 0; //No need to wait because we wait for the UART answers
+                    timer_start(TIMER_CAM_STEP + i, 0, 0); //No need to wait because we wait for the UART answers
 
                 //It usually takes between 2.1 and 2.7s, more than that is a timeout
                 cameraStatus_[i].timeoutTime = 3000;
 
                 if(confRegister_.debugUART == 5)
                 {
-                    uint64_t uptime = millis_uptime();
-                    sprintf(strToPrint_, "%.3fs: Camera %d Stop pressing button.\r\n# ", uptime/1000.0, i+1);
-                    uart_print(UART_DEBUG, strToPrint_);
+                    cameraDebugTrace(i, "Stop pressing button.\r\n# ");
                 }
                 break;
             case FSM_CAM_CONF_1:
                 {
+                    //Wait for the MewPro to tell that the camera booted
+                    if(mewpro_hasBooted(i))
+                    {
+                        //Booted :)
+                    }
                     //Time out?
-                    if(cameraStatus_[i].lastCommandTime + cameraStatus_[i].timeoutTime < uptime)
+                    else if(MS_ELAPSED(cameraStatus_[i].lastCommandTime, uptime)
+                            > cameraStatus_[i].timeoutTime)
                     {
-                        uint64_t uptime = millis_uptime();
-                        sprintf(strToPrint_, "%.3fs: Camera %d timeout :(\r\n# ", uptime/1000.0, i+1);
-                        uart_print(UART_DEBUG, strToPrint_);
+                        cameraDebugTrace(i, "timeout :(\r\n# ");
                         //It is timeout however we continue with the rest of the configuration as blind
                     }
-                    //Wait for uart to answer:
-                    else if(searchInUart(i, '@') == 0)
+                    else
                         continue; //Continue to the next camera
 
                     //With 10ms delay we dont have collisions but conf not always arrives
                     //With 50m delay seems that it never loses the conf
+                    cameraQueueClear(i);
                     if(cameraStatus_[i].slowMode)
-                        sleep_ms(200);
+                        cameraQueueAdd(i, NULL, 200, 0);
                     else
-                        sleep_ms(50);
+                        cameraQueueAdd(i, NULL, 50, 0);
 
                     //This works:
                     //YY00072100232016011100000001000000000000000000000000000000000001000007E50A14020A0B
                     struct RTCDateTime dateTime;
-                    char dateTimeCmd[100];
+                    char *dateTimeCmd = cameraDateTimeCmd_[i];
                     //i2c_RTC_getClockData(&dateTime);
                     uint32_t unixtimeNow = i2c_RTC_unixTime_now();
                     unixtimeNow = unixtimeNow + 7200;
@@ -415,124 +830,75 @@ int8_t cameraFSMlowLevelCheck()
                             dateTime.hours,
                             dateTime.minutes,
                             dateTime.seconds);
-                    uart_print(i + 1, dateTimeCmd);
-                    uart_flush(i + 1);
+                    //Next step as soon as the camera answers
+                    if(cameraStatus_[i].slowMode)
+                        cameraQueueAdd(i, dateTimeCmd, 2000, 1);
+                    else
+                        cameraQueueAdd(i, dateTimeCmd, 500, 1);
+                    cameraQueueModeConfiguration(i);
                     if(confRegister_.debugUART == 5)
                     {
-                        uint64_t uptime = millis_uptime();
-                        sprintf(strToPrint_, "%.3fs: Camera %d conf: '", uptime/1000.0, i+1);
-                        uart_print(UART_DEBUG, strToPrint_);
+                        cameraDebugTrace(i, "conf: '");
                         uart_print(UART_DEBUG, dateTimeCmd);
                         uart_print(UART_DEBUG, "'\r\n# ");
                     }
                 }
                 cameraStatus_[i].fsmStatus = FSM_CAM_CONF_2;
                 cameraStatus_[i].lastCommandTime = uptime;
-                if(cameraStatus_[i].slowMode)
-                    cameraStatus_[i].sleepTime = 2000;
-                else
-                    cameraStatus_[i].sleepTime = 500;
+                timer_start(TIMER_CAM_STEP + i, 0, 0);
 
                 if(confRegister_.debugUART == 5)
                 {
-                    uint64_t uptime = millis_uptime();
-                    sprintf(strToPrint_, "%.3fs: Camera %d is Configured.\r\n# ", uptime/1000.0, i+1);
-                    uart_print(UART_DEBUG, strToPrint_);
+                    cameraDebugTrace(i, "is Configured.\r\n# ");
                 }
                 break;
             case FSM_CAM_CONF_2:
-                if(cameraMode_[i] == CAMERAMODE_VID)
-                {
-                    //Configure video:
-                    //Depends of camera model:
-                    if(confRegister_.gopro_model[i] == 0)
-                    {
-                        uart_print(i + 1, CAM_SET_VIDEO_MODE);
-                        uart_flush(i + 1);
-                        sleep_ms(200);
-
-                        //GOPRO Hero4 Black
-                        uart_print(i + 1, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
-                        uart_print(i + 1, CAM_VIDEO_RES_2_7K_4_3);
-                        uart_print(i + 1, CAM_VIDEO_FPS_30);
-                        uart_print(i + 1, CAM_VIDEO_FOV_WIDE);
-                        //uart_print(i + 1, CAM_VIDEO_RES_720);
-                        //uart_print(i + 1, CAM_VIDEO_FPS_30);
-                        //uart_print(i + 1, CAM_VIDEO_FOV_NARROW);
-                        uart_print(i + 1, "\n");
-                        uart_flush(i + 1);
-                    }
-                    else
-                    {
-                        uart_print(i + 1, CAM_SET_VIDEO_MODE);
-                        uart_flush(i + 1);
-                        sleep_ms(200);
-
-                        //GOPRO Hero4 Silver is less capable unfortunately
-                        uart_print(i + 1, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
-                        uart_print(i + 1, CAM_VIDEO_RES_1440);
-                        uart_print(i + 1, CAM_VIDEO_FPS_48);
-                        uart_print(i + 1, CAM_VIDEO_FOV_WIDE);
-                        uart_print(i + 1, "\n");
-                        uart_flush(i + 1);
-                    }
-
-                }
-                else if(cameraMode_[i] == CAMERAMODE_PIC)
-                {
-                    //Configure picture: easypeasy
-                    uart_print(i + 1, CAM_SET_PHOTO_MODE);
-                    uart_flush(i + 1);
-                    if(cameraStatus_[i].slowMode)
-                        sleep_ms(200);
-                    else
-                        sleep_ms(100);
-                    uart_print(i + 1, CAM_PHOTO_RES_12MP_WIDE);
-                    uart_flush(i + 1);
-                }
-                else if(cameraMode_[i] == CAMERAMODE_VID_HIGHSPEED)
-                {
-                    //Configure video in high speed mode:
-                    uart_print(i + 1, CAM_SET_VIDEO_MODE);
-                    uart_flush(i + 1);
-                    sleep_ms(200);
-
-                    //GOPRO Hero4 Black
-                    uart_print(i + 1, CAM_PAYLOAD_VIDEO_RES_FPS_FOV);
-                    uart_print(i + 1, CAM_VIDEO_RES_960);
-                    uart_print(i + 1, CAM_VIDEO_FPS_120);
-                    uart_print(i + 1, CAM_VIDEO_FOV_WIDE);
-                    uart_print(i + 1, "\n");
-                    uart_flush(i + 1);
-                }
+                //Wait until the queue has sent the whole configuration
+                if(!cameraQueueIsEmpty(i))
+                    continue;
 
                 cameraStatus_[i].fsmStatus = FSM_CAM_DONOTHING;
                 cameraStatus_[i].cameraStatus = CAM_STATUS_ON;
+                cameraEnergyPhase(i, CAM_ENERGY_NONE, uptime);
                 if(confRegister_.debugUART == 5)
                 {
-                    uint64_t uptime = millis_uptime();
-                    sprintf(strToPrint_, "%.3fs: Camera %d is Ready.\r\n# ", uptime/1000.0, i+1);
-                    uart_print(UART_DEBUG, strToPrint_);
+                    cameraDebugTrace(i, "is Ready.\r\n# ");
                 }
                 break;
+            case FSM_CAM_PRESSBTNOFF:
+                //Wait for the power off command to leave the UART. On a
+                //shared UART the fallback only counts once the mux is ours
+                if(!uart_tx_isDrained(i + 1)
+                        && !uart_mux_request(i + 1, UART_MUX_HOLD))
+                {
+                    cameraStatus_[i].lastCommandTime = uptime;
+                    continue;
+                }
+                if(!uart_tx_isDrained(i + 1)
+                        && MS_ELAPSED(cameraStatus_[i].lastCommandTime, uptime) <= CAM_WAIT_TX_DRAINED)
+                    continue;
+                pressButton(i);
+                cameraStatus_[i].fsmStatus = FSM_CAM_PRESSBTNOFF_WAIT;
+                cameraStatus_[i].lastCommandTime = uptime;
+                timer_start(TIMER_CAM_STEP + i, CAM_WAIT_BUTTON /*+ 1000*/, 0);
+                break;
             case FSM_CAM_PRESSBTNOFF_WAIT:
                 releaseButton(i);
                 cameraStatus_[i].fsmStatus = FSM_CAM_POWEROFF_WAIT;
                 cameraStatus_[i].lastCommandTime = uptime;
                 if(cameraStatus_[i].slowMode)
-                    cameraStatus_[i].sleepTime = 5000;
+                    timer_start(TIMER_CAM_STEP + i, 5000, 0);
                 else
-                    cameraStatus_[i].sleepTime = 3500;
+                    timer_start(TIMER_CAM_STEP + i, 3500, 0);
                 break;
             case FSM_CAM_POWEROFF_WAIT:
                 cutPower(i);
                 cameraStatus_[i].fsmStatus = FSM_CAM_DONOTHING;
                 cameraStatus_[i].cameraStatus = CAM_STATUS_OFF;
+                cameraEnergyPhase(i, CAM_ENERGY_NONE, uptime);
                 if(confRegister_.debugUART == 5)
                 {
-                    uint64_t uptime = millis_uptime();
-                    sprintf(strToPrint_, "%.3fs: Camera %d is Off.\r\n# ", uptime/1000.0, i+1);
-                    uart_print(UART_DEBUG, strToPrint_);
+                    cameraDebugTrace(i, "is Off.\r\n# ");
                 }
                 break;
             }
@@ -541,12 +907,26 @@ int8_t cameraFSMlowLevelCheck()
     return 0;
 }
 
+/*
+ * It takes the next segment out of the video duration, no longer than
+ * gopro_videoSegment, and returns how long it has to be recorded [ms]
+ */
+uint32_t cameraVideoSegmentStart(uint8_t selectedCamera)
+{
+    uint32_t segment = cameraStatus_[selectedCamera].videoDuration;
+    if(confRegister_.gopro_videoSegment != 0
+            && segment > confRegister_.gopro_videoSegment)
+        segment = confRegister_.gopro_videoSegment;
+    cameraStatus_[selectedCamera].videoDuration -= segment;
+    return segment * 1000UL;
+}
+
 /**
  * It checks the low level tasks of the camera
  */
 int8_t cameraFSMhighLevelCheck()
 {
-    uint64_t uptime_ms = millis_uptime();
+    uint32_t uptime_ms = clock_now();
     //char strToPrint[50];
     uint8_t i;
     for(i = 0; i < 4; i++)
@@ -557,7 +937,7 @@ int8_t cameraFSMhighLevelCheck()
             continue;
         }
 
-        if(cameraStatus_[i].fsmStatusGlobalLastTime + cameraStatus_[i].fsmStatusGlobalsleepTime < uptime_ms)
+        if(!timer_isRunning(TIMER_CAM_GLOBAL + i))
         {
             //Move to next step!
             switch(cameraStatus_[i].fsmStatusGlobal)
@@ -565,38 +945,74 @@ int8_t cameraFSMhighLevelCheck()
             case FSMGLOBAL_CAM_PICTURESTART:
                 if(cameraStatus_[i].cameraStatus == CAM_STATUS_ON)
                 {
-                    cameraStatus_[i].fsmStatusGlobalLastTime = uptime_ms;
                     //Wait 1s for sending the picture command:
                     //cameraStatus_[i].fsmStatusGlobalsleepTime = 1500;
-                    cameraStatus_[i].fsmStatusGlobalsleepTime = confRegister_.gopro_pictureSleep;
+                    timer_start(TIMER_CAM_GLOBAL + i, confRegister_.gopro_pictureSleep, 0);
                     cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_PICTURESHOOT;
                 }
                 break;
             case FSMGLOBAL_CAM_PICTURESHOOT:
                 gopros_raw_cameraTakePicture(i);
-                cameraStatus_[i].fsmStatusGlobalLastTime = uptime_ms;
+                //Rest of the burst on this same boot
+                if(cameraStatus_[i].picturesLeft > 1)
+                {
+                    cameraStatus_[i].picturesLeft--;
+                    timer_start(TIMER_CAM_GLOBAL + i, confRegister_.gopro_burstInterval, 0);
+                    break;
+                }
+                if(cameraKeepAliveDecide(i, uptime_ms))
+                {
+                    //Stay on until the next picture, or a bit more if it
+                    //never comes
+                    cameraEnergyPhase(i, CAM_ENERGY_IDLE, uptime_ms);
+                    timer_start(TIMER_CAM_GLOBAL + i,
+                                MS_ELAPSED(uptime_ms, cameraStatus_[i].nextPictureTime)
+                                + CAM_KEEPALIVE_MARGIN, 0);
+                    cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_PICTUREIDLE;
+                    if(confRegister_.debugUART == 5)
+                    {
+                        cameraDebugTrace(i, "is kept on.\r\n# ");
+                    }
+                    break;
+                }
                 //Wait 1s before sending the off command
-                cameraStatus_[i].fsmStatusGlobalsleepTime = 1000;
+                timer_start(TIMER_CAM_GLOBAL + i, 1000, 0);
                 cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_OFF;
                 break;
+            case FSMGLOBAL_CAM_PICTUREIDLE:
+                //The next picture did not come
+                cameraKeepAliveRelease(i);
+                break;
             case FSMGLOBAL_CAM_OFF:
                 cameraPowerOff(i);
-                cameraStatus_[i].fsmStatusGlobalLastTime = uptime_ms;
-                cameraStatus_[i].fsmStatusGlobalsleepTime = 0;
+                timer_start(TIMER_CAM_GLOBAL + i, 0, 0);
                 cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_DISABLED;
                 break;
+            case FSMGLOBAL_CAM_VIDEONEXT:
             case FSMGLOBAL_CAM_VIDEOSTART:
                 gopros_raw_cameraStartRecordingVideo(i);
-                cameraStatus_[i].fsmStatusGlobalLastTime = uptime_ms;
-                //Wait 1s for sending the picture command:
-                cameraStatus_[i].fsmStatusGlobalsleepTime = (uint64_t)cameraStatus_[i].videoDuration * 1000UL;
+                timer_start(TIMER_CAM_GLOBAL + i, cameraVideoSegmentStart(i), 0);
                 cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_VIDEOSTOP;
                 break;
             case FSMGLOBAL_CAM_VIDEOSTOP:
                 gopros_raw_cameraStopRecordingVideo(i);
-                cameraStatus_[i].fsmStatusGlobalLastTime = uptime_ms;
+                if(cameraStatus_[i].videoDuration > 0)
+                {
+                    //Give the camera time to close the file and start again
+                    cameraStatus_[i].videoSegment++;
+                    timer_start(TIMER_CAM_GLOBAL + i, CAM_WAIT_SEGMENT, 0);
+                    cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_VIDEONEXT;
+
+                    uint8_t payload[5] = {0};
+                    payload[0] = i;
+                    payload[1] = cameraStatus_[i].videoSegment;
+                    payload[3] = (uint8_t)(0x00FF & (cameraStatus_[i].videoDuration >> 8));
+                    payload[4] = (uint8_t)(0x00FF & cameraStatus_[i].videoDuration);
+                    saveEventSimple(EVENT_CAMERA_VIDEO_SEGMENT, payload);
+                    break;
+                }
                 //Wait 2s for sending the picture command:
-                cameraStatus_[i].fsmStatusGlobalsleepTime = 2000;
+                timer_start(TIMER_CAM_GLOBAL + i, 2000, 0);
                 cameraStatus_[i].fsmStatusGlobal = FSMGLOBAL_CAM_OFF;
                 {
                     uint8_t payload[5] = {0};
@@ -612,12 +1028,80 @@ int8_t cameraFSMhighLevelCheck()
     return 0;
 }
 
+/*
+ * It switches on the next camera of the batch: never two closer than
+ * gopro_powerStagger, and only if the battery current leaves room for one
+ * more boot. Boot, configuration and picture of each camera go on in parallel
+ * on their own FSMs.
+ */
+void cameraBatchCheck()
+{
+    uint32_t uptime_ms = clock_now();
+    uint8_t i;
+
+    //Cameras kept on need no boot: pictures go straight away, and videos
+    //wait for them to be switched off to boot again in video mode
+    for(i = 0; i < 4; i++)
+    {
+        if(cameraBatch_[i].type == CAM_BATCH_NONE
+                || cameraStatus_[i].fsmStatusGlobal != FSMGLOBAL_CAM_PICTUREIDLE)
+            continue;
+        if(cameraBatch_[i].type == CAM_BATCH_PICTURE)
+        {
+            cameraTakePicture(i);
+            cameraBatch_[i].type = CAM_BATCH_NONE;
+        }
+        else
+            cameraKeepAliveRelease(i);
+    }
+
+    if(MS_ELAPSED(cameraBatchLastPowerOn_, uptime_ms) < confRegister_.gopro_powerStagger)
+        return;
+
+    for(i = 0; i < 4; i++)
+        if(cameraBatch_[i].type != CAM_BATCH_NONE && !cameraIsSwitchingOff(i))
+            break;
+    if(i >= 4)
+    {
+        cameraBatchWaitingSince_ = 0;
+        return;     //Nothing to do
+    }
+
+    //Is there room for another inrush current?
+    if(confRegister_.gopro_currentLimit != 0
+            && (int32_t)getBatteryCurrentNow() + CAM_BOOT_CURRENT
+                > (int32_t)confRegister_.gopro_currentLimit)
+    {
+        if(cameraBatchWaitingSince_ == 0)
+            cameraBatchWaitingSince_ = uptime_ms;
+        //Do not wait for ever, better a peak than a lost shot
+        if(MS_ELAPSED(cameraBatchWaitingSince_, uptime_ms) < CAM_BATCH_MAX_WAIT)
+            return;
+    }
+    cameraBatchWaitingSince_ = 0;
+
+    int8_t error;
+    if(cameraBatch_[i].type == CAM_BATCH_PICTURE)
+        error = cameraTakePicture(i);
+    else
+        error = cameraMakeVideo(i, cameraBatch_[i].cameraMode, cameraBatch_[i].duration);
+    cameraBatch_[i].type = CAM_BATCH_NONE;
+
+    //If it was busy nothing was switched on, next one can go now
+    if(error >= 0)
+        cameraBatchLastPowerOn_ = uptime_ms;
+}
+
 /**
  * This function must be called continuously
  */
 int8_t cameraFSMcheck()
 {
     int8_t result = 0;
+    //Learn what booting and idling costs
+    cameraEnergyCheck(clock_now());
+    //Switch on the cameras waiting on the batch
+    cameraBatchCheck();
     //Check low level stuff
     result += cameraFSMlowLevelCheck();
     //Check low level stuff
@@ -650,14 +1134,20 @@ int8_t cameraReadyStatus()
 int8_t cameraMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t duration)
 {
     //Check if it was already doing video, if so, just continue doing it non stop
-    if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP)
+    if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP
+            || cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEONEXT)
     {
         //Camera was already doing a video and waiting for it to be stopped.
-        //Lets just change the duration of the video to the new duration:
-        cameraStatus_[selectedCamera].videoDuration = duration;
-        uint64_t uptime_ms = millis_uptime();
-        cameraStatus_[selectedCamera].fsmStatusGlobalLastTime = uptime_ms;
-        cameraStatus_[selectedCamera].fsmStatusGlobalsleepTime = (uint64_t)cameraStatus_[selectedCamera].videoDuration * 1000UL;
+        //Lets just change the duration of the video to the new duration,
+        //counted from now on. The segment being recorded keeps its end, so
+        //only what it has left is taken out of the new duration:
+        uint32_t left = 0;
+        if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP)
+            left = (timer_remaining(TIMER_CAM_GLOBAL + selectedCamera) + 999) / 1000;
+        if(duration > left)
+            cameraStatus_[selectedCamera].videoDuration = duration - left;
+        else
+            cameraStatus_[selectedCamera].videoDuration = 0;
 
         uint8_t payload[5];
         payload[0] = selectedCamera;
@@ -686,9 +1176,9 @@ int8_t cameraMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t dura
         return -4; // Camera low battery error
 
     cameraStatus_[selectedCamera].fsmStatusGlobal = FSMGLOBAL_CAM_VIDEOSTART;
-    cameraStatus_[selectedCamera].fsmStatusGlobalsleepTime = 15000;
-    cameraStatus_[selectedCamera].fsmStatusGlobalLastTime = millis_uptime();
+    timer_start(TIMER_CAM_GLOBAL + selectedCamera, 15000, 0);
     cameraStatus_[selectedCamera].videoDuration = duration;
+    cameraStatus_[selectedCamera].videoSegment = 0;
 
     uint8_t payload[5];
     payload[0] = selectedCamera;
@@ -708,13 +1198,20 @@ int8_t cameraMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t dura
  */
 int8_t cameraInterruptVideo(uint8_t selectedCamera)
 {
+    //Not started yet, just forget it
+    if(cameraBatch_[selectedCamera].type == CAM_BATCH_VIDEO)
+    {
+        cameraBatch_[selectedCamera].type = CAM_BATCH_NONE;
+        return 0;
+    }
+
     if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTART
-            || cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP)
+            || cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP
+            || cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEONEXT)
     {
         //Make the video stop inmediately:
         cameraStatus_[selectedCamera].fsmStatusGlobal = FSMGLOBAL_CAM_VIDEOSTOP;
-        cameraStatus_[selectedCamera].fsmStatusGlobalsleepTime = 0;
-        cameraStatus_[selectedCamera].fsmStatusGlobalLastTime = millis_uptime();
+        timer_start(TIMER_CAM_GLOBAL + selectedCamera, 0, 0);
         cameraStatus_[selectedCamera].videoDuration = 0;
         return 0;
     }
@@ -732,10 +1229,34 @@ int8_t cameraInterruptVideo(uint8_t selectedCamera)
 }
 
 /**
- * It makes a picture in a completely automatic way (from power on to power off)
+ * It makes a picture in a completely automatic way (from power on to power off),
+ * or a burst of them depending on the flight state
  */
 int8_t cameraTakePicture(uint8_t selectedCamera)
 {
+    //Camera kept on since the last picture, just shoot
+    if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_PICTUREIDLE)
+    {
+        int16_t batteryVoltage = getBatteryVoltage(0);
+        if(batteryVoltage > 0 && batteryVoltage < 675)
+        {
+            cameraKeepAliveRelease(selectedCamera);
+            return -4; // Camera low battery error
+        }
+
+        uint32_t uptime_ms = clock_now();
+        cameraEnergyPhase(selectedCamera, CAM_ENERGY_NONE, uptime_ms);
+        cameraStatus_[selectedCamera].fsmStatusGlobal = FSMGLOBAL_CAM_PICTURESHOOT;
+        timer_start(TIMER_CAM_GLOBAL + selectedCamera, 0, 0);
+        cameraStatus_[selectedCamera].picturesLeft = cameraBurstCount();
+
+        uint8_t payload[5] = {0};
+        payload[0] = selectedCamera;
+        payload[1] = 1;     //No boot, it was kept on
+        saveEventSimple(EVENT_CAMERA_TIMELAPSE_PIC, payload);
+        return 0;
+    }
+
     if(cameraStatus_[selectedCamera].fsmStatusGlobal != FSMGLOBAL_CAM_DISABLED)
         return -1; //Camera was busy, return error!
 
@@ -751,8 +1272,8 @@ int8_t cameraTakePicture(uint8_t selectedCamera)
         return -4; // Camera low battery error
 
     cameraStatus_[selectedCamera].fsmStatusGlobal = FSMGLOBAL_CAM_PICTURESTART;
-    cameraStatus_[selectedCamera].fsmStatusGlobalsleepTime = 0;
-    cameraStatus_[selectedCamera].fsmStatusGlobalLastTime = millis_uptime();
+    timer_start(TIMER_CAM_GLOBAL + selectedCamera, 0, 0);
+    cameraStatus_[selectedCamera].picturesLeft = cameraBurstCount();
 
     uint8_t payload[5];
     payload[0] = selectedCamera;
@@ -766,3 +1287,115 @@ int8_t cameraTakePicture(uint8_t selectedCamera)
     gopros_raw_cameraInit(selectedCamera, CAMERAMODE_PIC);
     return cameraPowerOn(selectedCamera, 0);
 }
+
+/**
+ * It takes a picture with every camera of the mask (bit 0 = camera 1),
+ * switching them on one after the other. Cameras already waiting on the batch
+ * are not queued twice. Returns the number of cameras added.
+ */
+int8_t cameraBatchTakePicture(uint8_t cameraMask)
+{
+    int8_t added = 0;
+    uint8_t i;
+    for(i = 0; i < 4; i++)
+    {
+        if(((cameraMask >> i) & 1) && cameraBatch_[i].type == CAM_BATCH_NONE)
+        {
+            cameraBatch_[i].type = CAM_BATCH_PICTURE;
+            added++;
+        }
+    }
+    return added;
+}
+
+/**
+ * Like cameraMakeVideo() but the camera is switched on by the batch. If the
+ * camera is already recording, the duration is updated right away.
+ */
+int8_t cameraBatchMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t duration)
+{
+    if(cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEOSTOP
+            || cameraStatus_[selectedCamera].fsmStatusGlobal == FSMGLOBAL_CAM_VIDEONEXT)
+        return cameraMakeVideo(selectedCamera, cameraMode, duration);
+
+    //First video request wins, like on cameraMakeVideo(), but a video is more
+    //important than a picture still waiting
+    if(cameraBatch_[selectedCamera].type == CAM_BATCH_VIDEO)
+        return -1;
+
+    cameraBatch_[selectedCamera].type = CAM_BATCH_VIDEO;
+    cameraBatch_[selectedCamera].cameraMode = cameraMode;
+    cameraBatch_[selectedCamera].duration = duration;
+    return 0;
+}
+
+/**
+ * Tells when the next picture of the camera is expected, so it can decide to
+ * stay on until then.
+ */
+void cameraSetNextPicture(uint8_t selectedCamera, uint32_t nextPictureTime)
+{
+    cameraStatus_[selectedCamera].nextPictureTime = nextPictureTime;
+}
+
+/**
+ * Switches off a camera kept on between pictures, otherwise it does nothing
+ */
+void cameraKeepAliveRelease(uint8_t selectedCamera)
+{
+    if(cameraStatus_[selectedCamera].fsmStatusGlobal != FSMGLOBAL_CAM_PICTUREIDLE)
+        return;
+
+    cameraStatus_[selectedCamera].fsmStatusGlobal = FSMGLOBAL_CAM_OFF;
+    timer_start(TIMER_CAM_GLOBAL + selectedCamera, 0, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/*
+ * It stores a new level of a status pin, called from the port interrupts
+ */
+void cameraStatusPinEdge(uint8_t selectedCamera, uint8_t level)
+{
+    cameraStatusPin_[selectedCamera].level = level;
+    cameraStatusPin_[selectedCamera].edge = 1;
+    cameraStatusPin_[selectedCamera].edgeTime = millis_uptime();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Port 4 interrupt service routine, POWERCAM01..03_STATUS
+#pragma vector=PORT4_VECTOR
+__interrupt void Port_4(void)
+{
+    //Change the edge first so the next one is not lost
+    if(P4IFG & BIT0)
+    {
+        P4IES ^= BIT0;
+        P4IFG &= ~BIT0;
+        cameraStatusPinEdge(CAMERA01, (P4IN & BIT0) != 0);
+    }
+    if(P4IFG & BIT1)
+    {
+        P4IES ^= BIT1;
+        P4IFG &= ~BIT1;
+        cameraStatusPinEdge(CAMERA02, (P4IN & BIT1) != 0);
+    }
+    if(P4IFG & BIT2)
+    {
+        P4IES ^= BIT2;
+        P4IFG &= ~BIT2;
+        cameraStatusPinEdge(CAMERA03, (P4IN & BIT2) != 0);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Port 5 interrupt service routine, POWERCAM04_STATUS
+#pragma vector=PORT5_VECTOR
+__interrupt void Port_5(void)
+{
+    if(P5IFG & BIT7)
+    {
+        P5IES ^= BIT7;
+        P5IFG &= ~BIT7;
+        cameraStatusPinEdge(CAMERA04, (P5IN & BIT7) != 0);
+    }
+}
@@ -13,6 +13,9 @@
 #include "clock.h"
 #include "uart.h"
 #include "i2c_DS1338Z.h"
+#include "format.h"
+#include "mewpro.h"
+#include "timers.h"
 
 #define CAMERA01 0
 #define CAMERA02 1
@@ -36,6 +39,13 @@
 #define CAM_WAIT_POWER          5000
 #define CAM_WAIT_BUTTON         150
 #define CAM_WAIT_CONF_CHANGE    3000
+#define CAM_WAIT_TX_DRAINED     20      //Max time for a command to leave the UART
+#define CAM_BOOT_CURRENT        600     //mA, estimated peak of a camera booting
+#define CAM_BATCH_MAX_WAIT      10000   //ms waiting for the current to go down
+#define CAM_WAIT_SEGMENT        2000    //ms to close a video file before the next one
+#define CAM_KEEPALIVE_MARGIN    10000   //ms kept on after the expected picture
+#define CAM_DEF_CYCLE_CHARGE    7500000 //mA*ms, boot and power off until measured
+#define CAM_DEF_IDLE_CURRENT    250     //mA, on in picture mode until measured
 
 #define FSM_CAM_DONOTHING           0
 #define FSM_CAM_POWERON             1
@@ -56,9 +66,18 @@
 #define FSMGLOBAL_CAM_DISABLED          0
 #define FSMGLOBAL_CAM_PICTURESTART      1
 #define FSMGLOBAL_CAM_PICTURESHOOT      2
+#define FSMGLOBAL_CAM_PICTUREIDLE       3
 #define FSMGLOBAL_CAM_OFF               10
 #define FSMGLOBAL_CAM_VIDEOSTART        5
 #define FSMGLOBAL_CAM_VIDEOSTOP       6
+#define FSMGLOBAL_CAM_VIDEONEXT       7
+
+//Level of the POWERCAMxx_STATUS pins when the camera is switched on
+#define CAM_STATUS_PIN_ON   1
+//1 if the pin tells that the GoPro itself is on, and not only its power
+//rail. Then the button is not pressed if it switched on by itself. Not
+//verified on hardware, keep it 0 until then: the pin only shortens waits.
+#define CAM_STATUS_PIN_IS_CAMERA    0
 
 #define CAM_STATUS_OFF      0
 #define CAM_STATUS_ON       1
@@ -66,19 +85,91 @@
 #define CAM_STATUS_PICTURE  3
 #define CAM_STATUS_VIDEO    4
 
+#define CAM_KEEPALIVE_NEVER     0
+#define CAM_KEEPALIVE_AUTO      1
+#define CAM_KEEPALIVE_ALWAYS    2
+
+#define CAM_ENERGY_NONE     0
+#define CAM_ENERGY_BOOT     1
+#define CAM_ENERGY_IDLE     2
+#define CAM_ENERGY_OFF      3
+
+#define CAM_QUEUE_LENGTH    6
+
+/*
+ * One step of the camera command queue: the command is sent, and the next one
+ * waits delayAfter ms after it has left the UART. If expectReply is set, the
+ * next one goes as soon as the MewPro answers, and the delay is the timeout.
+ * A NULL command is just a wait.
+ */
+struct CameraCommand
+{
+    const char *command;
+    uint16_t delayAfter;        //[ms]
+    uint8_t expectReply;
+};
+
+struct CameraQueue
+{
+    struct CameraCommand commands[CAM_QUEUE_LENGTH];
+    uint8_t length;
+    uint8_t next;               //Next command to be sent
+    uint8_t waiting;            //1 while the last command sent is on its delay
+    uint32_t sentTime;
+};
+
+//POWERCAMxx_STATUS pin, updated by its edge interrupt
+struct CameraStatusPin
+{
+    uint8_t level;          //Current level of the pin
+    uint8_t edge;           //1 if it changed since the FSM step started
+    uint32_t edgeTime;      //millis_uptime() of the last edge
+};
+
+#define CAM_BATCH_NONE      0
+#define CAM_BATCH_PICTURE   1
+#define CAM_BATCH_VIDEO     2
+
+//Camera waiting on the batch to be switched on
+struct CameraBatchRequest
+{
+    uint8_t type;
+    uint8_t cameraMode;
+    uint16_t duration;      //s, only for videos
+};
+
+/*
+ * Energy model of a camera, learnt from the battery current: what a whole
+ * power cycle costs against staying on in picture mode. Other cameras in a
+ * transient spoil the measure, idle ones are discounted with their model.
+ */
+struct CameraEnergy
+{
+    uint8_t phase;          //What is being measured now
+    uint8_t cycleValid;
+    uint8_t idleValid;
+    int16_t baseline;       //mA of the rest of the system at power on
+    uint32_t lastSample;
+    int32_t cycleCharge;    //mA*ms of this boot and power off
+    int32_t idleCharge;     //mA*ms while idle
+    uint32_t idleTime;      //ms
+    uint32_t modelCycleCharge;  //mA*ms
+    uint16_t modelIdleCurrent;  //mA
+};
+
 struct CameraStatus
 {
     uint8_t cameraStatus;
     uint8_t fsmStatus;
-    uint64_t lastCommandTime;
-    uint64_t sleepTime;
-    uint64_t timeoutTime;
+    uint32_t lastCommandTime;
+    uint32_t timeoutTime;
     uint8_t slowMode;       //If 1, the camera will boot slower (Safest for videos)
 
     uint8_t fsmStatusGlobal;
-    uint64_t fsmStatusGlobalLastTime;
-    uint64_t fsmStatusGlobalsleepTime;
-    uint32_t videoDuration;
+    uint32_t videoDuration;     //s still to record after the current segment
+    uint8_t videoSegment;       //Segments closed of the current video
+    uint32_t nextPictureTime;   //millis_uptime() of the next picture, 0 if unknown
+    uint8_t picturesLeft;       //Pictures of the burst still to be taken
 };
 
 /*
@@ -173,6 +264,7 @@ argv[34]: second
 #define CAM_VIDEO_FOV_NARROW        "02"
 #define CAM_VIDEO_FOV_LINEAR        "04"
 
+#define CAM_PAYLOAD_VIDEO_EXP       "YY0002280001"
 #define CAM_VIDEO_EXP_AUTO          "YY000228000100\n"
 #define CAM_VIDEO_EXP_1_12_5        "YY000228000101\n"
 #define CAM_VIDEO_EXP_1_15          "YY000228000102\n"
@@ -225,6 +317,13 @@ int8_t gopros_raw_cameraStartRecordingVideo(uint8_t selectedCamera);
 int8_t gopros_raw_cameraStopRecordingVideo(uint8_t selectedCamera);
 int8_t gopros_raw_cameraFormatSDCard(uint8_t selectedCamera);
 int8_t gopros_raw_cameraRawSendCommand(uint8_t selectedCamera, char * cmd);
+void cameraVideoProfilesBuild();
+int8_t cameraQueueAdd(uint8_t selectedCamera, const char *command,
+                      uint16_t delayAfter, uint8_t expectReply);
+void cameraQueueClear(uint8_t selectedCamera);
+uint8_t cameraQueueIsEmpty(uint8_t selectedCamera);
+void cameraStatusPinsInit();
+uint8_t cameraStatusPinIsOn(uint8_t selectedCamera);
 int8_t cameraPowerOn(uint8_t selectedCamera, uint8_t slowMode);
 int8_t cameraPowerOff(uint8_t selectedCamera);
 int8_t cameraPowerOffUnsafe(uint8_t selectedCamera);
@@ -233,5 +332,9 @@ int8_t cameraReadyStatus();
 int8_t cameraMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t duration);
 int8_t cameraInterruptVideo(uint8_t selectedCamera);
 int8_t cameraTakePicture(uint8_t selectedCamera);
+int8_t cameraBatchTakePicture(uint8_t cameraMask);
+void cameraSetNextPicture(uint8_t selectedCamera, uint32_t nextPictureTime);
+void cameraKeepAliveRelease(uint8_t selectedCamera);
+int8_t cameraBatchMakeVideo(uint8_t selectedCamera, uint8_t cameraMode, uint16_t duration);
 
 #endif /* GOPROS_H_ */
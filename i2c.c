@@ -58,16 +58,41 @@ void i2c_master_init()
         HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW0) |= UCSWRST;
         // I2C mode, Master mode, sync
         HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW0) |= UCMODE_3 | UCMST | UCSYNC;
-        // baudrate = SMCLK / 20 = 400k
-        HWREG16(i2cPorts[i].baseAddress + OFS_UCBxBRW) = 0x0014;
-        // baudrate = SMCLK / 40 = 200k
-        //HWREG16(i2cPorts[i].baseAddress + OFS_UCBxBRW) = 0x0028;
+        // baudrate = 400k, 100k at 1MHz
+        HWREG16(i2cPorts[i].baseAddress + OFS_UCBxBRW) = i2c_divider();
         HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW0) &= ~UCSWRST;
         //Clock low timeout, approximately 28 ms
         HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW1) |= UCCLTO_1;
     }
 }
 
+/**
+ * Prescaler of SMCLK for 400kHz on the current clock profile. At 1MHz it
+ * can not be made with a good duty cycle so the bus goes at 100kHz.
+ */
+uint16_t i2c_divider(void)
+{
+    uint16_t divider = ((uint16_t)clock_getMHz() * 1000) / 400;
+    if(divider < 10)
+        divider = 10;
+    return divider;
+}
+
+/**
+ * After a change of the clock profile, it sets the prescaler of both buses.
+ * Nothing must be on the bus meanwhile.
+ */
+void i2c_retime(void)
+{
+    uint8_t i;
+    for(i = 0; i < 2; i++)
+    {
+        HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW0) |= UCSWRST;
+        HWREG16(i2cPorts[i].baseAddress + OFS_UCBxBRW) = i2c_divider();
+        HWREG16(i2cPorts[i].baseAddress + OFS_UCBxCTLW0) &= ~UCSWRST;
+    }
+}
+
 /**
  * It starts i2c transmission on selected bus.
  */
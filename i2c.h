@@ -29,6 +29,8 @@
 //* PUBLIC FUNCTION DECLARATIONS :                                             *
 //******************************************************************************
 void i2c_master_init();
+uint16_t i2c_divider(void);
+void i2c_retime(void);
 int8_t i2c_begin_transmission(uint8_t busSelect, uint8_t address,
                               uint8_t asReceiver);
 int8_t i2c_write_firstbyte(uint8_t busSelect, uint8_t *buffer);
@@ -112,7 +112,8 @@ int8_t i2c_ADXL345_activateActivityDetection()
     buffer[1] = 0x10;
     ack |= i2c_write(I2C_BUS00, ADXL345_ADDRESS, buffer, 2, 0);
 
-    //Enable interrupt
+    //Enable interrupt, it is shown on the console by the scheduler
+    deferred_setHandler(DEFERRED_MOVEMENT, i2c_ADXL345_printMovement);
     P3IE |= BIT7;
     //Low to High edge
     P3IES &= ~BIT7;
@@ -209,6 +210,14 @@ int8_t i2c_ADXL345_getMovementDetected()
     return flagIMUDetection_;
 }
 
+/**
+ * Movement detected by the interrupt, once for all the ones queued
+ */
+void i2c_ADXL345_printMovement(const uint8_t *data, uint8_t length)
+{
+    uart_print(UART_DEBUG, "***\r\n");
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Port 3 interrupt service routine
@@ -220,7 +229,7 @@ __interrupt void Port_3(void)
         if(seconds_uptime() > 10)
         {
             flagIMUDetection_++;
-            uart_print(UART_DEBUG, "***\r\n");
+            deferred_push(DEFERRED_MOVEMENT, 0);
         }
         P3IFG &= ~BIT7;
     }
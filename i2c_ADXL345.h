@@ -12,6 +12,8 @@
 #include <stdint.h>
 #include "i2c.h"
 #include "configuration.h"
+#include "uart.h"
+#include "deferred.h"
 
 #define ADXL345_ADDRESS 0x1D
 
@@ -64,6 +66,7 @@ int8_t i2c_ADXL345_getIntStatus(uint8_t *interruptRegister,
 
 int8_t i2c_ADXL345_activateActivityDetection();
 int8_t i2c_ADXL345_getMovementDetected();
+void i2c_ADXL345_printMovement(const uint8_t *data, uint8_t length);
 
 
 #endif /* I2C_ADXL345_H_ */
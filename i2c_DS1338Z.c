@@ -137,6 +137,16 @@ int8_t i2c_RTC_getClockData(struct RTCDateTime *dateTime)
  * for the correct time just in case.
  */
 uint32_t i2c_RTC_unixTime_now()
+{
+    return i2c_RTC_unixTime_at(seconds_uptime());
+}
+
+/**
+ * UnixTime of the second uptime_s of seconds_uptime(). Use it with the
+ * seconds of a millis_uptime() reading, so its ms are the fraction of
+ * the UnixTime.
+ */
+uint32_t i2c_RTC_unixTime_at(uint32_t uptime_s)
 {
     uint32_t now = seconds_uptime();
     if(unixTimeStatus_.uptime + RTC_READ_PERIOD < now || unixTimeStatus_.uptime == 0)
@@ -156,7 +166,8 @@ uint32_t i2c_RTC_unixTime_now()
             //TODO
         }
     }
-    return unixTimeStatus_.unixtime + (now - unixTimeStatus_.uptime);
+    //Also right if the RTC was read after uptime_s
+    return unixTimeStatus_.unixtime + (uptime_s - unixTimeStatus_.uptime);
 
 }
 
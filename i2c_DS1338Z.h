@@ -49,6 +49,7 @@ int8_t   i2c_RTC_getClockDataRAW(struct RTCDateTime *dateTime);
 int8_t   i2c_RTC_getClockData(struct RTCDateTime *dateTime);
 
 uint32_t i2c_RTC_unixTime_now();
+uint32_t i2c_RTC_unixTime_at(uint32_t uptime_s);
 int8_t   i2c_RTC_set_unixTime(uint32_t unixtime);
 
 void convert_from_unixTime(uint32_t unixtime, struct RTCDateTime *dateTime);
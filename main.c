@@ -94,6 +94,7 @@
 #include "terminal.h"
 #include "flight_sequence.h"
 #include "leds.h"
+#include "scheduler.h"
 
 /*
  * Init all GPIO and MCU subsystems
@@ -164,9 +165,18 @@ void init_board()
     //previously configured port settings:
     PM5CTL0 &= ~LOCKLPM5;
 
+    //Camera status pins, with interrupts on their edges
+    cameraStatusPinsInit();
+
     //Init clock to 8MHz using internal DCO, millis etc
     clock_init();
 
+    //Free running 1us timebase to profile tasks and drivers
+    profiler_init();
+
+    //Timers of the modules, on the scheduler tick
+    timer_init();
+
     //WDT Enabled
     WDTCTL = WDTPW | DAE_WDTKICK;
 
@@ -197,6 +207,9 @@ void init_board()
     //Init configuration
     int8_t error = configuration_init();
 
+    //Video commands of the profiles, from the configuration
+    cameraVideoProfilesBuild();
+
     //Init NOR Memory
     if(error != 0)
     {
@@ -209,8 +222,10 @@ void init_board()
 
     //Register that a boot happened just now:
     struct EventLine newEvent = {0};
-    newEvent.upTime = (uint32_t) millis_uptime();
-    newEvent.unixTime = i2c_RTC_unixTime_now();
+    uint32_t elapsedSeconds;
+    uint16_t millis;
+    newEvent.upTime = millis_uptime_split(&elapsedSeconds, &millis);
+    newEvent.unixTime = i2c_RTC_unixTime_at(elapsedSeconds);
     //newEvent.state = 0;
     //newEvent.sub_state = 0;
     newEvent.event = EVENT_BOOT;
@@ -241,7 +256,7 @@ uint8_t lastLEDStatus_ = 0;
  * If everything is ok it will blink once per second
  * If baro error it blinks twice as fast
  */
-void ledDebugBlink(uint64_t uptime)
+void ledDebugBlink(uint32_t uptime)
 {
     uint16_t blinkPeriod = 1000;
     if(getBaroIsOnError())
@@ -282,6 +297,98 @@ void ledDebugBlink(uint64_t uptime)
     }
 }
 
+/*
+ * Tasks of the scheduler
+ */
+void taskWatchdog(void)
+{
+    //Kick WDT
+    WDTCTL = WDTPW | DAE_WDTKICK;
+}
+
+void taskTimers(void)
+{
+    //Expire the timers of the modules before they run
+    timer_service();
+}
+
+void taskDeferred(void)
+{
+    //Work left by the interrupts
+    deferred_run();
+}
+
+void taskTerminal(void)
+{
+    //Read UART Debug:
+    terminal_readAndProcessCommands();
+}
+
+void taskCameras(void)
+{
+    //Run camera FSM continuously
+    cameraFSMcheck();
+}
+
+void taskSensors(void)
+{
+    //Every sensor is read on its own period
+    sensorsRead();
+}
+
+void taskTelemetry(void)
+{
+    //Save telemetry periodically
+    saveTelemetry();
+}
+
+void taskMemory(void)
+{
+    //Check operations ongoing on the NOR
+    checkMemory();
+}
+
+void taskFlightSignal(void)
+{
+    //Sunrise signal
+    checkFlightSignal();
+}
+
+void taskFlightSequence(void)
+{
+    //Fligh sequence
+    checkFlightSequence();
+}
+
+void taskRTC(void)
+{
+    //Keep the UnixTime up to date
+    i2c_RTC_unixTime_now();
+}
+
+void taskLeds(void)
+{
+    uint32_t uptime = clock_now();
+
+    //Blink CPU LED
+    ledDebugBlink(uptime);
+
+    //Blink FP Green LED once per 5s
+    if(uptime % 5000 > 10)
+        led_g_off();
+    else
+        led_g_on();
+
+    //Keep the Red LED On if there is power on the cameras
+    if((P4OUT & BIT6) &&
+            (P4OUT & BIT5) &&
+            (P4OUT & BIT4) &&
+            (P2OUT & BIT7))
+        led_r_off();
+    else
+        led_r_on();
+}
+
 /**
  * main.c
  */
@@ -318,56 +425,24 @@ int main(void)
     //Terminal begin by default thanks
     terminal_start();
 
-	while(1)
-	{
-	    //Kick WDT
-        WDTCTL = WDTPW | DAE_WDTKICK;
-
-	    //Read Uptime:
-	    uint64_t uptime = millis_uptime();
-
-	    //UnixTime now:
-	    uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
-
-	    //Read UART Debug:
-	    terminal_readAndProcessCommands();
-
-	    //Run camera FSM continuously
-	    cameraFSMcheck();
-
-	    //Read all sensors
-	    sensorsRead();
-
-	    //Save telemetry periodically
-	    saveTelemetry();
-
-	    //Save telemetry periodically
-        checkMemory();
-
-        //Save telemetry periodically
-        checkFlightSignal();
-
-	    //Fligh sequence
-	    checkFlightSequence();
-
-	    //Blink CPU LED
-	    ledDebugBlink(uptime);
-
-	    //Blink FP Green LED once per 5s
-        if(uptime % 5000 > 10)
-            led_g_off();
-        else
-            led_g_on();
-
-        //Keep the Red LED On if there is power on the cameras
-        if((P4OUT & BIT6) &&
-                (P4OUT & BIT5) &&
-                (P4OUT & BIT4) &&
-                (P2OUT & BIT7))
-            led_r_off();
-        else
-            led_r_on();
-	};
+    //All the work is done by the tasks, in this order on every tick. Slow
+    //tasks are spread over different ticks with their phase
+    //                 name         function            period  phase  budget [ms]
+    scheduler_addTask("wdt",        taskWatchdog,           10,     0,      0);
+    scheduler_addTask("timers",     taskTimers,             10,     0,      1);
+    scheduler_addTask("deferred",   taskDeferred,           10,     0,      2);
+    scheduler_addTask("terminal",   taskTerminal,           10,     0,      5);
+    scheduler_addTask("cameras",    taskCameras,            10,     0,      5);
+    scheduler_addTask("sensors",    taskSensors,            10,     0,     10);
+    scheduler_addTask("telemetry",  taskTelemetry,         100,    30,     50);
+    scheduler_addTask("memory",     taskMemory,            100,    40,      5);
+    scheduler_addTask("signal",     taskFlightSignal,      100,    50,      5);
+    scheduler_addTask("sequence",   taskFlightSequence,    100,    60,     10);
+    scheduler_addTask("rtc",        taskRTC,              1000,    70,     10);
+    scheduler_addTask("leds",       taskLeds,               10,     0,      1);
+
+    //It never returns
+    scheduler_run();
 
 	//It should never reach here
 }
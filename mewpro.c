@@ -0,0 +1,134 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ */
+
+#include "mewpro.h"
+
+struct MewProParser mewproParser_[4] = {0};
+
+/**
+ * Resets the parser of one camera, to be called every time the camera boots
+ */
+void mewpro_init(uint8_t selectedCamera)
+{
+    memset(&mewproParser_[selectedCamera], 0, sizeof(struct MewProParser));
+}
+
+/**
+ * It registers the command that has just been sent so its reply can be
+ * matched. Only the 3 bytes of header after the "YY" are kept.
+ */
+void mewpro_expect(uint8_t selectedCamera, const char *command)
+{
+    struct MewProParser *parser = &mewproParser_[selectedCamera];
+    uint8_t i;
+    for(i = 0; i < 6; i++)
+    {
+        if(command[i + 2] == 0)
+            break;
+        parser->expected[i] = command[i + 2];
+    }
+    parser->expected[i] = 0;
+    parser->result = MEWPRO_NONE;
+}
+
+/*
+ * Returns 1 if the two characters are an hexadecimal "00"
+ */
+static uint8_t isStatusOk(const char *status)
+{
+    return status[0] == '0' && status[1] == '0';
+}
+
+/*
+ * It classifies a complete line received from the MewPro
+ */
+static uint8_t parseLine(struct MewProParser *parser)
+{
+    if(parser->length < 8 || parser->line[0] != 'X' || parser->line[1] != 'X')
+        return MEWPRO_OTHER;
+    if(parser->expected[0] == 0
+            || strncmp(&parser->line[2], parser->expected, strlen(parser->expected)) != 0)
+        return MEWPRO_OTHER;
+
+    //It is the answer to our command
+    if(parser->length >= 10 && !isStatusOk(&parser->line[8]))
+    {
+        parser->errors++;
+        parser->result = MEWPRO_ERROR;
+    }
+    else
+        parser->result = MEWPRO_ACK;
+    parser->expected[0] = 0;
+    return parser->result;
+}
+
+/**
+ * It consumes everything received from the camera and returns the most
+ * relevant result found: BOOT, then ACK/ERROR, then OTHER.
+ */
+uint8_t mewpro_parse(uint8_t selectedCamera)
+{
+    struct MewProParser *parser = &mewproParser_[selectedCamera];
+    uint8_t result = MEWPRO_NONE;
+    uint8_t lineResult;
+    int16_t nchars = uart_available(selectedCamera + 1);
+    while(nchars-- > 0)
+    {
+        char c = uart_read(selectedCamera + 1);
+        if(c == '@')
+        {
+            parser->booted = 1;
+            parser->length = 0;
+            result = MEWPRO_BOOT;
+            continue;
+        }
+        if(c == '\r' || c == '\n')
+        {
+            if(parser->length == 0)
+                continue;   //Empty line or second half of "\r\n"
+            if(parser->length < MEWPRO_LINE_MAX)
+            {
+                parser->line[parser->length] = 0;
+                lineResult = parseLine(parser);
+                parser->lastReplyTime = millis_uptime();
+                if(result == MEWPRO_NONE || (result == MEWPRO_OTHER && lineResult != MEWPRO_OTHER))
+                    result = lineResult;
+            }
+            parser->length = 0;
+            continue;
+        }
+        //Too long lines are dropped entirely until the next end of line
+        if(parser->length < MEWPRO_LINE_MAX - 1)
+            parser->line[parser->length++] = c;
+        else
+            parser->length = MEWPRO_LINE_MAX;
+    }
+    return result;
+}
+
+/**
+ * Result of the last expected command, MEWPRO_NONE while still pending
+ */
+uint8_t mewpro_getResult(uint8_t selectedCamera)
+{
+    return mewproParser_[selectedCamera].result;
+}
+
+/**
+ * Returns 1 once the '@' of the boot has been received
+ */
+uint8_t mewpro_hasBooted(uint8_t selectedCamera)
+{
+    return mewproParser_[selectedCamera].booted;
+}
+
+/**
+ * Number of commands answered with an error status since last boot
+ */
+uint16_t mewpro_getErrors(uint8_t selectedCamera)
+{
+    return mewproParser_[selectedCamera].errors;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ */
+
+#ifndef MEWPRO_H_
+#define MEWPRO_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "clock.h"
+#include "uart.h"
+
+#define MEWPRO_LINE_MAX     48
+
+// Results returned by the parser
+#define MEWPRO_NONE     0   //Nothing new / reply still pending
+#define MEWPRO_BOOT     1   //'@' received, MewPro finished booting the camera
+#define MEWPRO_ACK      2   //Reply to the expected command, status OK
+#define MEWPRO_ERROR    3   //Reply to the expected command, status not OK
+#define MEWPRO_OTHER    4   //Complete line that does not answer our command
+
+/*
+ * MewPro answers on the serial port with text lines. Replies from the camera
+ * to a "YYaabbcc..." command come back as "XXaabbcc[ss]...": same 3 bytes of
+ * header and an optional status byte, 00 means OK. A lonely '@' is printed
+ * once the camera has booted.
+ */
+struct MewProParser
+{
+    char line[MEWPRO_LINE_MAX];
+    uint8_t length;
+    char expected[7];       //Header of the command waiting for an answer
+    uint8_t result;         //Result of the expected command
+    uint8_t booted;
+    uint16_t errors;
+    uint32_t lastReplyTime;
+};
+
+void mewpro_init(uint8_t selectedCamera);
+void mewpro_expect(uint8_t selectedCamera, const char *command);
+uint8_t mewpro_parse(uint8_t selectedCamera);
+uint8_t mewpro_getResult(uint8_t selectedCamera);
+uint8_t mewpro_hasBooted(uint8_t selectedCamera);
+uint16_t mewpro_getErrors(uint8_t selectedCamera);
+
+#endif /* MEWPRO_H_ */
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "profiler.h"
+
+//Statistics survive resets, so a reboot after a long stall does not hide it
+#pragma PERSISTENT (profilerRegister_)
+struct ProfilerRegister profilerRegister_ = {0};
+
+uint16_t profilerOverflows_ = 0;                //High word of the timebase
+uint32_t profilerStart_[PROFILER_STAGES] = {0}; //[us] of the running begin()
+const char *profilerNames_[PROFILER_STAGES] =
+{
+    "sleep_ms",
+    "uart_flush",
+    "spi",
+    "nor_read",
+    "nor_write",
+    "nor_erase",
+};
+
+/**
+ * It starts the free running 1us timebase on TA1. Statistics are kept from
+ * before the reset unless the stages changed.
+ */
+void profiler_init(void)
+{
+    if(profilerRegister_.magic != PROFILER_MAGIC)
+        profiler_reset();
+
+    profilerOverflows_ = 0;
+    TA1CTL = MC__STOP | TACLR;
+    profiler_retime();
+}
+
+/**
+ * It divides SMCLK down to 1MHz for the current clock profile, continuous
+ * mode, interrupt on overflow every 65.5ms. The count goes on from where it
+ * was, so stages running across a change of clock are still measured.
+ */
+void profiler_retime(void)
+{
+    uint16_t divider = ID__8;
+    uint16_t expansion = TAIDEX_0;
+    if(clock_getMHz() == 1)
+        divider = ID__1;
+    else if(clock_getMHz() == 16)
+        expansion = TAIDEX_1;    // 8 * 2
+
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    uint32_t now = profiler_now();
+    TA1CTL = MC__STOP;
+    TA1EX0 = expansion;
+    TA1CTL = TASSEL__SMCLK | divider | TACLR | TAIE;
+    TA1R = (uint16_t)now;
+    profilerOverflows_ = now >> 16;
+    TA1CTL |= MC__CONTINUOUS;
+    __set_interrupt_state(interruptState);
+}
+
+/**
+ * Microseconds of the timebase, it rolls over every 71 minutes so only
+ * differences make sense
+ */
+uint32_t profiler_now(void)
+{
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    uint16_t high = profilerOverflows_;
+    uint16_t low = TA1R;
+    //Overflow not yet served by the interrupt
+    if((TA1CTL & TAIFG) && low < 0x8000)
+        high++;
+    __set_interrupt_state(interruptState);
+    return ((uint32_t)high << 16) | low;
+}
+
+/**
+ * It marks the start of a stage
+ */
+void profiler_begin(uint8_t stage)
+{
+    if(stage >= PROFILER_STAGES)
+        return;
+    profilerStart_[stage] = profiler_now();
+}
+
+/**
+ * It marks the end of a stage, it adds the duration to its statistics and
+ * returns it [us]
+ */
+uint32_t profiler_end(uint8_t stage)
+{
+    uint32_t duration = profiler_now();
+    if(stage >= PROFILER_STAGES)
+        return 0;
+    duration -= profilerStart_[stage];
+
+    struct ProfilerStage *stats = &profilerRegister_.stage[stage];
+    if(stats->count == 0 || duration < stats->min)
+        stats->min = duration;
+    if(duration > stats->max)
+        stats->max = duration;
+    stats->count++;
+    stats->total += duration;
+
+    //Log2 of the duration is the bin
+    uint8_t bin = 0;
+    uint32_t value = duration >> 1;
+    while(value != 0 && bin < PROFILER_BINS - 1)
+    {
+        value >>= 1;
+        bin++;
+    }
+    stats->histogram[bin]++;
+    return duration;
+}
+
+/**
+ * Name of the stage on the console, the tasks are named by the scheduler
+ */
+void profiler_setName(uint8_t stage, const char *name)
+{
+    if(stage >= PROFILER_STAGES)
+        return;
+    profilerNames_[stage] = name;
+}
+
+/**
+ * It prints min/avg/max of every stage with its histogram. Only the
+ * non empty bins are printed, as "<upper limit in us>:count".
+ */
+void profiler_print(void)
+{
+    char strToPrint[100];
+    uart_print(UART_DEBUG, "stage           count       min       avg       max [us]\r\n");
+    uint8_t i;
+    for(i = 0; i < PROFILER_STAGES; i++)
+    {
+        struct ProfilerStage *stats = &profilerRegister_.stage[i];
+        if(stats->count == 0)
+            continue;
+        const char *name = profilerNames_[i];
+        if(name == 0)
+            name = "?";
+        sprintf(strToPrint, "%-12s %8lu  %8lu  %8lu  %8lu\r\n",
+                name,
+                stats->count,
+                stats->min,
+                (uint32_t)(stats->total / stats->count),
+                stats->max);
+        uart_print(UART_DEBUG, strToPrint);
+
+        uart_print(UART_DEBUG, "   ");
+        uint8_t bin;
+        for(bin = 0; bin < PROFILER_BINS; bin++)
+        {
+            if(stats->histogram[bin] == 0)
+                continue;
+            if(bin == PROFILER_BINS - 1)
+                sprintf(strToPrint, " >%lu:%lu", 1ul << bin,
+                        stats->histogram[bin]);
+            else
+                sprintf(strToPrint, " <%lu:%lu", 1ul << (bin + 1),
+                        stats->histogram[bin]);
+            uart_print(UART_DEBUG, strToPrint);
+        }
+        uart_print(UART_DEBUG, "\r\n");
+    }
+}
+
+/**
+ * It clears all the statistics
+ */
+void profiler_reset(void)
+{
+    memset(&profilerRegister_, 0, sizeof(profilerRegister_));
+    profilerRegister_.magic = PROFILER_MAGIC;
+}
+
+/**
+ * Overflow of the timebase
+ */
+#pragma vector=TIMER1_A1_VECTOR
+__interrupt void TIMER_A1_A1_ISR(void)
+{
+    switch(__even_in_range(TA1IV, TAIV__TAIFG))
+    {
+    case TAIV__TAIFG:
+        profilerOverflows_++;
+        break;
+    default:
+        break;
+    }
+}
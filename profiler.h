@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <msp430.h>
+#include <stdio.h>
+#include <string.h>
+#include "uart.h"
+#include "clock.h"
+
+// Free running timebase on TA1, SMCLK divided to 1us per count
+#define PROFILER_MAGIC          0x9F43  // Change it if the stages change
+
+// Stages measured, the drivers first and then the tasks of the scheduler
+#define PROFILER_SLEEP_MS       0
+#define PROFILER_UART_FLUSH     1
+#define PROFILER_SPI            2
+#define PROFILER_NOR_READ       3
+#define PROFILER_NOR_WRITE      4
+#define PROFILER_NOR_ERASE      5
+#define PROFILER_TASK_FIRST     6
+#define PROFILER_TASKS          12
+#define PROFILER_STAGES         (PROFILER_TASK_FIRST + PROFILER_TASKS)
+
+// Histogram bin N counts durations of [2^N, 2^(N+1)) us, the first one
+// includes 0us and the last one everything over 2^23us (8.4s)
+#define PROFILER_BINS           24
+
+struct ProfilerStage
+{
+    uint32_t count;
+    uint32_t min;               //[us]
+    uint32_t max;               //[us]
+    uint64_t total;             //[us] to get the average
+    uint32_t histogram[PROFILER_BINS];
+};
+
+struct ProfilerRegister
+{
+    uint16_t magic;
+    struct ProfilerStage stage[PROFILER_STAGES];
+};
+
+void profiler_init(void);
+void profiler_retime(void);
+uint32_t profiler_now(void);
+void profiler_begin(uint8_t stage);
+uint32_t profiler_end(uint8_t stage);
+void profiler_setName(uint8_t stage, const char *name);
+void profiler_print(void);
+void profiler_reset(void);
+
+#endif /* PROFILER_H_ */
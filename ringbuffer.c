@@ -0,0 +1,174 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "ringbuffer.h"
+
+/**
+ * It sets the ring on its buffer, empty. Returns -1 if size is not a power
+ * of 2 (or over 32768), the ring is then left with no room.
+ */
+int8_t ring_init(struct RingBuffer *ring, uint8_t *data, uint16_t size)
+{
+    ring->start = 0;
+    ring->end = 0;
+    ring->data = data;
+    if(size == 0 || size > 0x8000 || (size & (size - 1)) != 0)
+    {
+        ring->mask = 0;
+        ring->data = 0;
+        return -1;
+    }
+    ring->mask = size - 1;
+    return 0;
+}
+
+/**
+ * It discards everything waiting. Consumer side, the producer may keep on
+ * writing.
+ */
+void ring_clear(struct RingBuffer *ring)
+{
+    ring->start = ring->end;
+}
+
+/**
+ * Bytes waiting to be read
+ */
+uint16_t ring_count(const struct RingBuffer *ring)
+{
+    return ring->end - ring->start;
+}
+
+/**
+ * Room left for writing
+ */
+uint16_t ring_free(const struct RingBuffer *ring)
+{
+    return ring_size(ring) - ring_count(ring);
+}
+
+/**
+ * Capacity of the ring
+ */
+uint16_t ring_size(const struct RingBuffer *ring)
+{
+    if(ring->data == 0)
+        return 0;
+    return ring->mask + 1;
+}
+
+/**
+ * It writes a byte, returns -1 if the ring is full
+ */
+int8_t ring_push(struct RingBuffer *ring, uint8_t byte)
+{
+    uint16_t end = ring->end;
+    if((uint16_t)(end - ring->start) >= ring_size(ring))
+        return -1;
+    ring->data[end & ring->mask] = byte;
+    RING_BARRIER();
+    ring->end = end + 1;
+    return 0;
+}
+
+/**
+ * It writes as much of the buffer as it fits, with at most two copies and
+ * one update of the end. Returns the number of bytes written.
+ */
+uint16_t ring_write(struct RingBuffer *ring, const uint8_t *buffer,
+                    uint16_t length)
+{
+    uint16_t end = ring->end;
+    uint16_t room = ring_free(ring);
+    if(length > room)
+        length = room;
+    if(length == 0)
+        return 0;
+
+    uint16_t position = end & ring->mask;
+    uint16_t first = ring->mask + 1 - position;
+    if(first > length)
+        first = length;
+    memcpy(&ring->data[position], buffer, first);
+    memcpy(ring->data, buffer + first, length - first);
+    RING_BARRIER();
+    ring->end = end + length;
+    return length;
+}
+
+/**
+ * It reads a byte, returns -1 if the ring is empty
+ */
+int8_t ring_pop(struct RingBuffer *ring, uint8_t *byte)
+{
+    uint16_t start = ring->start;
+    if(start == ring->end)
+        return -1;
+    *byte = ring->data[start & ring->mask];
+    RING_BARRIER();
+    ring->start = start + 1;
+    return 0;
+}
+
+/**
+ * It reads up to length bytes, returns the number of bytes read
+ */
+uint16_t ring_read(struct RingBuffer *ring, uint8_t *buffer, uint16_t length)
+{
+    uint16_t start = ring->start;
+    uint16_t count = ring->end - start;
+    if(length > count)
+        length = count;
+    if(length == 0)
+        return 0;
+
+    uint16_t position = start & ring->mask;
+    uint16_t first = ring->mask + 1 - position;
+    if(first > length)
+        first = length;
+    memcpy(buffer, &ring->data[position], first);
+    memcpy(buffer + first, ring->data, length - first);
+    RING_BARRIER();
+    ring->start = start + length;
+    return length;
+}
+
+/**
+ * Byte at offset from the next one to be read, without taking it. The
+ * caller must check ring_count() first.
+ */
+uint8_t ring_peek(const struct RingBuffer *ring, uint16_t offset)
+{
+    return ring->data[(ring->start + offset) & ring->mask];
+}
+
+/**
+ * Contiguous block of bytes waiting to be read, from the next one up to the
+ * end of the buffer at most, for a DMA. Returns its length, take it with
+ * ring_skip() once done.
+ */
+uint16_t ring_span(const struct RingBuffer *ring, uint8_t **span)
+{
+    uint16_t start = ring->start;
+    uint16_t count = ring->end - start;
+    uint16_t position = start & ring->mask;
+    uint16_t first = ring->mask + 1 - position;
+    *span = &ring->data[position];
+    if(count < first)
+        return count;
+    return first;
+}
+
+/**
+ * It takes length bytes without copying them, after ring_span() or
+ * ring_peek()
+ */
+void ring_skip(struct RingBuffer *ring, uint16_t length)
+{
+    uint16_t count = ring->end - ring->start;
+    if(length > count)
+        length = count;
+    ring->start += length;
+}
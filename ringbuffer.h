@@ -0,0 +1,54 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// Byte ring buffer for one producer and one consumer, for example an
+// interrupt and the main loop. Sizes are powers of 2 up to 32768.
+//
+// start and end count bytes for ever and wrap at 65536, the position on the
+// buffer is the count masked with size - 1. Only the producer writes end
+// and only the consumer writes start, each with a single 16 bit store after
+// the data has been copied, so neither side needs to disable interrupts.
+// The used size is end - start, so the whole buffer can be filled.
+// RING_BARRIER keeps the compiler from moving the copy of the data past that
+// store, only volatile accesses are kept in order between themselves.
+#if defined(__GNUC__)
+#define RING_BARRIER()  __asm__ __volatile__("" ::: "memory")
+#else
+#define RING_BARRIER()  __asm("")   //TI compiler does not move code across it
+#endif
+
+struct RingBuffer
+{
+    uint8_t *data;
+    uint16_t mask;              //Size - 1
+    volatile uint16_t start;    //Bytes read, moved by the consumer
+    volatile uint16_t end;      //Bytes written, moved by the producer
+};
+
+int8_t ring_init(struct RingBuffer *ring, uint8_t *data, uint16_t size);
+void ring_clear(struct RingBuffer *ring);
+uint16_t ring_count(const struct RingBuffer *ring);
+uint16_t ring_free(const struct RingBuffer *ring);
+uint16_t ring_size(const struct RingBuffer *ring);
+
+// Producer side
+int8_t ring_push(struct RingBuffer *ring, uint8_t byte);
+uint16_t ring_write(struct RingBuffer *ring, const uint8_t *buffer,
+                    uint16_t length);
+
+// Consumer side
+int8_t ring_pop(struct RingBuffer *ring, uint8_t *byte);
+uint16_t ring_read(struct RingBuffer *ring, uint8_t *buffer, uint16_t length);
+uint8_t ring_peek(const struct RingBuffer *ring, uint16_t offset);
+uint16_t ring_span(const struct RingBuffer *ring, uint8_t **span);
+void ring_skip(struct RingBuffer *ring, uint16_t length);
+
+#endif /* RINGBUFFER_H_ */
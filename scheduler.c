@@ -0,0 +1,206 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "scheduler.h"
+
+struct SchedulerTask tasks_[SCHEDULER_MAX_TASKS] = {0};
+uint8_t tasksCount_ = 0;
+uint32_t schedulerLastTick_ = 0;
+uint32_t schedulerMissedTicks_ = 0;     //Ticks with no pass, the previous was too long
+//Time on every flight state, and how much of it asleep, to get the duty cycle
+uint32_t powerTicks_[FLIGHTSTATE_COUNT] = {0};     //[ticks]
+uint64_t powerSleep_[FLIGHTSTATE_COUNT] = {0};     //[ACLK ticks]
+
+/**
+ * It adds a task to the scheduler, all times in ms (rounded to the 10ms tick).
+ * The phase delays the first run so tasks with the same period do not all
+ * fall on the same tick. Returns the task number or -1 if there is no room.
+ */
+int8_t scheduler_addTask(const char *name, void (*function)(void),
+                         uint16_t period, uint16_t phase, uint16_t budget)
+{
+    if(tasksCount_ >= SCHEDULER_MAX_TASKS)
+        return -1;
+
+    struct SchedulerTask *task = &tasks_[tasksCount_];
+    task->name = name;
+    task->function = function;
+    task->period = period / CLOCK_TICK_MS;
+    if(task->period == 0)
+        task->period = 1;
+    task->budget = budget;
+    task->deadline = clock_tick_count() + phase / CLOCK_TICK_MS;
+    profiler_setName(PROFILER_TASK_FIRST + tasksCount_, name);
+    tasksCount_++;
+    return tasksCount_ - 1;
+}
+
+/*
+ * Nothing to do until the next tick, so the CPU sleeps in LPM0 until the tick
+ * interrupt wakes it up. The rest of the interrupts (UARTs, DMA, ports, I2C,
+ * SPI) are served while sleeping and the tasks process their data on the
+ * next tick. LPM3 is not used because all the peripherals run on SMCLK.
+ */
+static void scheduler_idle(void)
+{
+    uint16_t start = clock_aclk_now();
+
+    //The tick could arrive between the check and the sleep, so check it with
+    //the interrupts disabled: GIE is set again with the LPM0 bits at once
+    __disable_interrupt();
+    if(!clock_tick_pending())
+        __bis_SR_register(LPM0_bits | GIE);
+    else
+        __enable_interrupt();
+    __no_operation();
+
+    if(confRegister_.flightState < FLIGHTSTATE_COUNT)
+        powerSleep_[confRegister_.flightState] += clock_aclk_elapsed(start);
+}
+
+/**
+ * It runs the tasks for ever. On every tick the tasks whose deadline has been
+ * reached are executed, always in the order they were added.
+ */
+void scheduler_run(void)
+{
+    schedulerLastTick_ = clock_tick_count();
+    while(1)
+    {
+        if(!clock_tick_elapsed())
+        {
+            scheduler_idle();
+            continue;
+        }
+
+        uint32_t tick = clock_tick_count();
+        if(tick - schedulerLastTick_ > 1)
+            schedulerMissedTicks_ += tick - schedulerLastTick_ - 1;
+        if(confRegister_.flightState < FLIGHTSTATE_COUNT)
+            powerTicks_[confRegister_.flightState] += tick - schedulerLastTick_;
+        schedulerLastTick_ = tick;
+        clock_updateNow();
+
+        uint8_t i;
+        for(i = 0; i < tasksCount_; i++)
+        {
+            struct SchedulerTask *task = &tasks_[i];
+            //Tasks before this one may have taken some ticks
+            uint32_t now = clock_tick_count();
+            int32_t lateness = (int32_t)(now - task->deadline);
+            if(lateness < 0)
+                continue;
+
+            if(lateness > task->maxLateness)
+                task->maxLateness = lateness > 0xFFFF ? 0xFFFF : (uint16_t)lateness;
+
+            profiler_begin(PROFILER_TASK_FIRST + i);
+            task->function();
+            uint32_t duration = profiler_end(PROFILER_TASK_FIRST + i) / 1000;
+            if(duration > 0xFFFF)
+                duration = 0xFFFF;
+
+            task->runs++;
+            task->lastDuration = duration;
+            if(duration > task->maxDuration)
+                task->maxDuration = duration;
+            if(task->budget != 0 && duration > task->budget)
+                task->overruns++;
+
+            //If it is already late for the next one, skip it instead of
+            //running it several times in a row
+            task->deadline += task->period;
+            if((int32_t)(now - task->deadline) >= 0)
+                task->deadline = now + task->period;
+        }
+    }
+}
+
+/**
+ * It prints the statistics of every task on the console
+ */
+void scheduler_printStats(void)
+{
+    char strToPrint[100];
+    sprintf(strToPrint, "Tick %ld, %ld ticks missed\r\n",
+            clock_tick_count(), schedulerMissedTicks_);
+    uart_print(UART_DEBUG, strToPrint);
+    sprintf(strToPrint, "Deferred work: max %u of %u queued, %u lost\r\n",
+            deferred_maxUsed(), DEFERRED_QUEUE_LENGTH, deferred_dropped());
+    uart_print(UART_DEBUG, strToPrint);
+    uart_print(UART_DEBUG, "task        period  budget    runs  last   max  late  overruns\r\n");
+    uint8_t i;
+    for(i = 0; i < tasksCount_; i++)
+    {
+        struct SchedulerTask *task = &tasks_[i];
+        sprintf(strToPrint, "%-10s  %6u  %6u  %6lu  %4u  %4u  %4u  %8u\r\n",
+                task->name,
+                task->period * CLOCK_TICK_MS,
+                task->budget,
+                task->runs,
+                task->lastDuration,
+                task->maxDuration,
+                task->maxLateness * CLOCK_TICK_MS,
+                task->overruns);
+        uart_print(UART_DEBUG, strToPrint);
+    }
+}
+
+/**
+ * It clears the statistics of every task
+ */
+void scheduler_resetStats(void)
+{
+    uint8_t i;
+    for(i = 0; i < tasksCount_; i++)
+    {
+        tasks_[i].runs = 0;
+        tasks_[i].overruns = 0;
+        tasks_[i].lastDuration = 0;
+        tasks_[i].maxDuration = 0;
+        tasks_[i].maxLateness = 0;
+    }
+    schedulerMissedTicks_ = 0;
+}
+
+/*
+ * Per thousand of the time the CPU was awake
+ */
+static uint16_t scheduler_activePermille(uint32_t ticks, uint64_t sleep)
+{
+    uint64_t total = (uint64_t)ticks * CLOCK_ACLK_TICKS_S / (1000u / CLOCK_TICK_MS);
+    if(total == 0)
+        return 0;
+    if(sleep > total)
+        return 0;
+    return 1000u - (uint16_t)(sleep * 1000u / total);
+}
+
+/**
+ * It prints the time spent on every flight state and the part of it the CPU
+ * was awake (active duty cycle)
+ */
+void scheduler_printPower(void)
+{
+    char strToPrint[80];
+    uint32_t ticks = 0;
+    uint64_t sleep = 0;
+    uint8_t i;
+    for(i = 0; i < FLIGHTSTATE_COUNT; i++)
+    {
+        if(powerTicks_[i] == 0)
+            continue;
+        uint16_t active = scheduler_activePermille(powerTicks_[i], powerSleep_[i]);
+        sprintf(strToPrint, "State %d: %ld s, CPU active %d.%d%%\r\n",
+                i, powerTicks_[i] / (1000u / CLOCK_TICK_MS), active / 10, active % 10);
+        uart_print(UART_DEBUG, strToPrint);
+        ticks += powerTicks_[i];
+        sleep += powerSleep_[i];
+    }
+    uint16_t active = scheduler_activePermille(ticks, sleep);
+    sprintf(strToPrint, "Total: %ld s, CPU active %d.%d%%\r\n",
+            ticks / (1000u / CLOCK_TICK_MS), active / 10, active % 10);
+    uart_print(UART_DEBUG, strToPrint);
+}
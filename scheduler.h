@@ -0,0 +1,46 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <msp430.h>
+#include <stdio.h>
+#include "clock.h"
+#include "uart.h"
+#include "configuration.h"
+#include "profiler.h"
+
+#define SCHEDULER_MAX_TASKS     12
+
+/*
+ * A task of the cooperative scheduler. Tasks run to completion, in the order
+ * they were added, on the 10ms tick where their deadline is reached.
+ */
+struct SchedulerTask
+{
+    const char *name;
+    void (*function)(void);
+    uint16_t period;            //[ticks] 1 = every tick
+    uint16_t budget;            //[ms] a run longer than this is an overrun
+    uint32_t deadline;          //[tick] of the next run
+
+    //Statistics
+    uint32_t runs;
+    uint16_t overruns;          //Runs longer than the budget
+    uint16_t lastDuration;      //[ms]
+    uint16_t maxDuration;       //[ms]
+    uint16_t maxLateness;       //[ticks] jitter, how late it started
+};
+
+int8_t scheduler_addTask(const char *name, void (*function)(void),
+                         uint16_t period, uint16_t phase, uint16_t budget);
+void scheduler_run(void);
+void scheduler_printStats(void);
+void scheduler_resetStats(void);
+void scheduler_printPower(void);
+
+#endif /* SCHEDULER_H_ */
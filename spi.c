@@ -46,6 +46,26 @@ void spi_init(uint8_t clockrate)
 
 }
 
+/**
+ * Prescaler of SMCLK for the fastest SPI clock the NORs take on the current
+ * clock profile
+ */
+uint8_t spi_divider(void)
+{
+    return (clock_getMHz() + SPI_MAX_MHZ - 1) / SPI_MAX_MHZ;
+}
+
+/**
+ * After a change of the clock profile, it sets the prescaler again. No
+ * transfer must be ongoing.
+ */
+void spi_retime(void)
+{
+    UCB1CTLW0 |= UCSWRST;
+    UCB1BRW = spi_divider();
+    UCB1CTLW0 &= ~UCSWRST;
+}
+
 /**
  * Send a single byte and do not expect any answer
  */
@@ -69,6 +89,7 @@ int8_t spi_write_read(uint8_t *bufferOut,
                       uint8_t *bufferIn,
                       unsigned int bufferInLenght)
 {
+    profiler_begin(PROFILER_SPI);
     //First we send:
     while(bufferOutLenght)
     {
@@ -103,6 +124,7 @@ int8_t spi_write_read(uint8_t *bufferOut,
         if(bufferInLenght != 0)
             *bufferIn++;
     }
+    profiler_end(PROFILER_SPI);
 
     //Return without errors
     return 0;
@@ -8,8 +8,11 @@
 
 #include <msp430.h>
 #include <stdint.h>
+#include "profiler.h"
+#include "clock.h"
 
 // Clock max. on MSP430 is 16 MHz
+#define SPI_MAX_MHZ     8   // Kept as on the 8MHz profile, whatever SMCLK is
 
 #define CR_8MHZ 0x01
 #define CR_4MHZ 0x02
@@ -27,6 +30,8 @@
 #define FLASH_CS2_ON    (P8OUT &= ~BIT3)
 
 void spi_init(uint8_t clockrate);
+uint8_t spi_divider(void);
+void spi_retime(void);
 int8_t spi_write_instruction(uint8_t instruction);
 int8_t spi_write_read(uint8_t *bufferOut,
                       unsigned int bufferOutLenght,
@@ -106,6 +106,7 @@ int8_t spi_NOR_readFromAddress(uint32_t readAddress, uint8_t * buffer, uint16_t
     if (spi_NOR_checkWriteInProgress(deviceSelect))
         return -1;
 
+    profiler_begin(PROFILER_NOR_READ);
     led_b_on();
     // Chip Select ON
     if (deviceSelect == CS_FLASH1)
@@ -129,6 +130,7 @@ int8_t spi_NOR_readFromAddress(uint32_t readAddress, uint8_t * buffer, uint16_t
     FLASH_CS2_OFF;
 
     led_b_off();
+    profiler_end(PROFILER_NOR_READ);
 
     return 0;
 }
@@ -146,6 +148,7 @@ int8_t spi_NOR_writeToAddress(uint32_t writeAddress, uint8_t * buffer, uint16_t
     if (spi_NOR_checkWriteInProgress(deviceSelect))
         return -1;
 
+    profiler_begin(PROFILER_NOR_WRITE);
     led_b_on();
 
     // Enable Write Operations
@@ -183,6 +186,7 @@ int8_t spi_NOR_writeToAddress(uint32_t writeAddress, uint8_t * buffer, uint16_t
     NOR_writeEnableDisable(0, deviceSelect);
 
     led_b_off();
+    profiler_end(PROFILER_NOR_WRITE);
 
     return 0;
 }
@@ -197,6 +201,7 @@ int8_t spi_NOR_sectorErase(uint32_t sectorAddress, uint8_t deviceSelect)
     if (spi_NOR_checkWriteInProgress(deviceSelect))
         return -1;
 
+    profiler_begin(PROFILER_NOR_ERASE);
     led_b_on();
 
     // Enable Write Operations
@@ -230,6 +235,7 @@ int8_t spi_NOR_sectorErase(uint32_t sectorAddress, uint8_t deviceSelect)
     NOR_writeEnableDisable(0, deviceSelect);
 
     led_b_off();
+    profiler_end(PROFILER_NOR_ERASE);
 
     return 0;
 }
@@ -196,6 +196,19 @@ def translateEvent(code, payload1, payload2, payload3, payload4, payload5):
             else:
                 somethingElse = " due to unknown reason."
         return "Flight sequence changed to '" + event + "'" + somethingElse
+    elif code == "21":
+        remaining = int(payload5[0]) + int(payload4) * 256
+        return "Camera '" + payload1 + "' closed video segment " + payload2 \
+             + ", " + str(remaining) + "s left to record."
+    elif code == "22":
+        somethingElse = ""
+        if payload3 != "0":
+            somethingElse = " Self-test failed (" + payload3 + ")"
+            if payload4 != "0":
+                somethingElse += ", going back to 8MHz"
+            somethingElse += "."
+        return "Clock changed from " + payload1 + "MHz to " + payload2 + "MHz." \
+             + somethingElse
 
     elif code == "30":
         #print(payload1, payload2, payload3, payload4, payload5)
@@ -15,6 +15,10 @@ char lastIssuedCommand_[CMD_MAX_LEN] = {0};
 char commandHistory_[CMD_MAX_SAVE][CMD_MAX_LEN] = {0};
 uint8_t cmdSelector_ = 0;
 
+// Debug baudrate handshake, 1 while the new baudrate is not yet confirmed
+uint8_t baudPending_ = 0;
+uint32_t baudDeadline_ = 0;
+
 // PRIVATE FUNCTIONS
 //char subcommand_[CMD_MAX_LEN] = {0};
 void extractCommandPart(char * command, uint8_t desiredPart, char * commandPart);
@@ -28,6 +32,13 @@ void processI2CCommand(char * command);
 void processCameraCommand(char * command);
 void processTMCommand(char * command);
 void processMemoryCommand(char * command);
+void processBaudCommand(char * command);
+void printLine(char *end);
+void printStatus();
+char *formatDate(char *out, uint32_t unixTime);
+char *formatStatistics(char *out, int16_t *values, uint8_t decimals);
+char *formatCSV(char *out, int32_t value);
+void baudFallback(void);
 
 /**
  * A parted command is separated into multiple parts by means of spaces.
@@ -193,6 +204,59 @@ void processTerminalCommand(char * command)
     uart_print(UART_DEBUG, strToPrint_);
 }
 
+/**
+ * It switches the debug UART to a higher baudrate, i.e. "baud 921600".
+ * The host has to reconnect at the new baudrate and send "baud ok" before
+ * BAUD_CONFIRM_TIMEOUT, otherwise we go back to 115200 so the console is never
+ * lost. A reboot always starts again at 115200.
+ */
+void processBaudCommand(char * command)
+{
+    char baudSubcommand[CMD_MAX_LEN] = {0};
+    extractCommandPart((char *) command, 1, (char *) baudSubcommand);
+
+    if(baudSubcommand[0] == 0)
+    {
+        sprintf(strToPrint_, "Debug baudrate is %ld\r\n",
+                uart_baudrate_value(uart_get_baudrate(UART_DEBUG)));
+        uart_print(UART_DEBUG, strToPrint_);
+        return;
+    }
+
+    uint32_t desiredBaudrate = atol(baudSubcommand);
+    uint8_t baudrate;
+    for(baudrate = 0; baudrate < BR_COUNT; baudrate++)
+        if(uart_baudrate_value(baudrate) == desiredBaudrate)
+            break;
+
+    if(baudrate == BR_COUNT || baudrate < BR_115200)
+    {
+        uart_print(UART_DEBUG, "Incorrect baudrate, valid are 115200, 230400, 460800 and 921600\r\n");
+        return;
+    }
+
+    sprintf(strToPrint_, "Switching to %ld baud, send 'baud ok' within %d s to confirm...\r\n",
+            desiredBaudrate, BAUD_CONFIRM_TIMEOUT / 1000);
+    uart_print(UART_DEBUG, strToPrint_);
+    uart_flush(UART_DEBUG);
+
+    uart_set_baudrate(UART_DEBUG, baudrate);
+    uart_clear_buffer(UART_DEBUG);
+    baudPending_ = 1;
+    baudDeadline_ = millis_uptime() + BAUD_CONFIRM_TIMEOUT;
+}
+
+/**
+ * Nobody confirmed the new baudrate, go back to 115200
+ */
+void baudFallback(void)
+{
+    baudPending_ = 0;
+    uart_set_baudrate(UART_DEBUG, BR_115200);
+    uart_clear_buffer(UART_DEBUG);
+    uart_print(UART_DEBUG, "\r\nBaudrate not confirmed, back to 115200\r\n# ");
+}
+
 /**
  * TODO please complete
  */
@@ -266,6 +330,66 @@ void processConfCommand(char * command)
         uart_print(UART_DEBUG, strToPrint_);
         sprintf(strToPrint_, "gopro_pictureSleep = %d\r\n", confRegister_.gopro_pictureSleep);
         uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_powerStagger = %d\r\n", confRegister_.gopro_powerStagger);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_currentLimit = %d\r\n", confRegister_.gopro_currentLimit);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_keepAlive = %d\r\n", confRegister_.gopro_keepAlive);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_burstCount = %d\r\n", confRegister_.gopro_burstCount);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_burstInterval = %d\r\n", confRegister_.gopro_burstInterval);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_burstStates = 0x%02X\r\n", confRegister_.gopro_burstStates);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "gopro_videoSegment = %d\r\n", confRegister_.gopro_videoSegment);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_resolution[0] = 0x%02X\r\n", confRegister_.video_resolution[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_resolution[1] = 0x%02X\r\n", confRegister_.video_resolution[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_resolution[2] = 0x%02X\r\n", confRegister_.video_resolution[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_resolution[3] = 0x%02X\r\n", confRegister_.video_resolution[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fps[0] = 0x%02X\r\n", confRegister_.video_fps[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fps[1] = 0x%02X\r\n", confRegister_.video_fps[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fps[2] = 0x%02X\r\n", confRegister_.video_fps[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fps[3] = 0x%02X\r\n", confRegister_.video_fps[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fov[0] = 0x%02X\r\n", confRegister_.video_fov[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fov[1] = 0x%02X\r\n", confRegister_.video_fov[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fov[2] = 0x%02X\r\n", confRegister_.video_fov[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_fov[3] = 0x%02X\r\n", confRegister_.video_fov[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_exposure[0] = 0x%02X\r\n", confRegister_.video_exposure[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_exposure[1] = 0x%02X\r\n", confRegister_.video_exposure[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_exposure[2] = 0x%02X\r\n", confRegister_.video_exposure[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_exposure[3] = 0x%02X\r\n", confRegister_.video_exposure[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[0] = 0x%04X\r\n", confRegister_.video_select[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[1] = 0x%04X\r\n", confRegister_.video_select[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[2] = 0x%04X\r\n", confRegister_.video_select[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[3] = 0x%04X\r\n", confRegister_.video_select[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[4] = 0x%04X\r\n", confRegister_.video_select[4]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[5] = 0x%04X\r\n", confRegister_.video_select[5]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "video_select[6] = 0x%04X\r\n", confRegister_.video_select[6]);
+        uart_print(UART_DEBUG, strToPrint_);
 
         sprintf(strToPrint_, "launch_heightThreshold = %ld\r\n", confRegister_.launch_heightThreshold);
         uart_print(UART_DEBUG, strToPrint_);
@@ -284,6 +408,22 @@ void processConfCommand(char * command)
 
         sprintf(strToPrint_, "flight_timelapse_period = %d\r\n", confRegister_.flight_timelapse_period);
         uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPeriod[0] = %d\r\n", confRegister_.flight_timelapse_camPeriod[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPeriod[1] = %d\r\n", confRegister_.flight_timelapse_camPeriod[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPeriod[2] = %d\r\n", confRegister_.flight_timelapse_camPeriod[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPeriod[3] = %d\r\n", confRegister_.flight_timelapse_camPeriod[3]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPhase[0] = %d\r\n", confRegister_.flight_timelapse_camPhase[0]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPhase[1] = %d\r\n", confRegister_.flight_timelapse_camPhase[1]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPhase[2] = %d\r\n", confRegister_.flight_timelapse_camPhase[2]);
+        uart_print(UART_DEBUG, strToPrint_);
+        sprintf(strToPrint_, "flight_timelapse_camPhase[3] = %d\r\n", confRegister_.flight_timelapse_camPhase[3]);
+        uart_print(UART_DEBUG, strToPrint_);
         sprintf(strToPrint_, "flight_camerasFirstLeg = 0x%02X\r\n", confRegister_.flight_camerasFirstLeg);
         uart_print(UART_DEBUG, strToPrint_);
         sprintf(strToPrint_, "flight_camerasSecondLeg = 0x%02X\r\n", confRegister_.flight_camerasSecondLeg);
@@ -425,6 +565,126 @@ void processConfCommand(char * command)
     {
         confRegister_.gopro_pictureSleep = valueToSet;
     }
+    else if (strcmp("gopro_powerStagger", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_powerStagger = valueToSet;
+    }
+    else if (strcmp("gopro_currentLimit", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_currentLimit = valueToSet;
+    }
+    else if (strcmp("gopro_keepAlive", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_keepAlive = valueToSet;
+    }
+    else if (strcmp("gopro_burstCount", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_burstCount = valueToSet;
+    }
+    else if (strcmp("gopro_burstInterval", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_burstInterval = valueToSet;
+    }
+    else if (strcmp("gopro_burstStates", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_burstStates = valueToSet;
+    }
+    else if (strcmp("gopro_videoSegment", (char *)selectedParameter) == 0)
+    {
+        confRegister_.gopro_videoSegment = valueToSet;
+    }
+    else if (strcmp("video_resolution[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_resolution[0] = valueToSet;
+    }
+    else if (strcmp("video_resolution[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_resolution[1] = valueToSet;
+    }
+    else if (strcmp("video_resolution[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_resolution[2] = valueToSet;
+    }
+    else if (strcmp("video_resolution[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_resolution[3] = valueToSet;
+    }
+    else if (strcmp("video_fps[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fps[0] = valueToSet;
+    }
+    else if (strcmp("video_fps[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fps[1] = valueToSet;
+    }
+    else if (strcmp("video_fps[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fps[2] = valueToSet;
+    }
+    else if (strcmp("video_fps[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fps[3] = valueToSet;
+    }
+    else if (strcmp("video_fov[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fov[0] = valueToSet;
+    }
+    else if (strcmp("video_fov[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fov[1] = valueToSet;
+    }
+    else if (strcmp("video_fov[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fov[2] = valueToSet;
+    }
+    else if (strcmp("video_fov[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_fov[3] = valueToSet;
+    }
+    else if (strcmp("video_exposure[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_exposure[0] = valueToSet;
+    }
+    else if (strcmp("video_exposure[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_exposure[1] = valueToSet;
+    }
+    else if (strcmp("video_exposure[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_exposure[2] = valueToSet;
+    }
+    else if (strcmp("video_exposure[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_exposure[3] = valueToSet;
+    }
+    else if (strcmp("video_select[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[0] = valueToSet;
+    }
+    else if (strcmp("video_select[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[1] = valueToSet;
+    }
+    else if (strcmp("video_select[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[2] = valueToSet;
+    }
+    else if (strcmp("video_select[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[3] = valueToSet;
+    }
+    else if (strcmp("video_select[4]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[4] = valueToSet;
+    }
+    else if (strcmp("video_select[5]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[5] = valueToSet;
+    }
+    else if (strcmp("video_select[6]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.video_select[6] = valueToSet;
+    }
     else if (strcmp("leds", (char *)selectedParameter) == 0)
     {
         confRegister_.leds = valueToSet;
@@ -465,6 +725,38 @@ void processConfCommand(char * command)
     {
         confRegister_.flight_timelapse_period = valueToSet;
     }
+    else if (strcmp("flight_timelapse_camPeriod[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPeriod[0] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPeriod[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPeriod[1] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPeriod[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPeriod[2] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPeriod[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPeriod[3] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPhase[0]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPhase[0] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPhase[1]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPhase[1] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPhase[2]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPhase[2] = valueToSet;
+    }
+    else if (strcmp("flight_timelapse_camPhase[3]", (char *)selectedParameter) == 0)
+    {
+        confRegister_.flight_timelapse_camPhase[3] = valueToSet;
+    }
     else if (strcmp("flight_camerasFirstLeg", (char *)selectedParameter) == 0)
     {
         confRegister_.flight_camerasFirstLeg = valueToSet;
@@ -534,6 +826,13 @@ void processConfCommand(char * command)
         return;
     }
 
+    //New periods or phases take effect from now on
+    if (strncmp("flight_timelapse", (char *)selectedParameter, 16) == 0)
+        timelapseReschedule();
+    //Video commands are only built when the profiles change
+    if (strncmp("video_", (char *)selectedParameter, 6) == 0)
+        cameraVideoProfilesBuild();
+
     uint8_t payload[5] = {0};
     payload[0] = selectedParameter[0];
     payload[1] = selectedParameter[1];
@@ -681,7 +980,7 @@ void processCameraCommand(char * command)
         //gopros_cameraInit(selectedCamera, CAMERAMODE_VID);
 
         cameraPowerOn(selectedCamera, 0);
-        uint64_t uptime = millis_uptime();
+        uint32_t uptime = millis_uptime();
         sprintf(strToPrint_, "%.3fs: Camera %c booting...\r\n", uptime/1000.0, command[7]);
         uint8_t payload[5] = {0};
         payload[0] = selectedCamera;
@@ -893,6 +1192,57 @@ void processTMCommand(char * command)
 /**
  * Prints current status of the CPU
  */
+/**
+ * It prints strToPrint_ up to the end pointer returned by the format_ functions
+ */
+void printLine(char *end)
+{
+    uart_write(UART_DEBUG, (uint8_t *)strToPrint_, end - strToPrint_);
+}
+
+/**
+ * Writes the date as "20YY/MM/DD HH:mm:ss"
+ */
+char *formatDate(char *out, uint32_t unixTime)
+{
+    struct RTCDateTime dateTime;
+    convert_from_unixTime(unixTime, &dateTime);
+    out = format_str(out, "20");
+    out = format_uint(out, dateTime.year, 2);
+    out = format_char(out, '/');
+    out = format_uint(out, dateTime.month, 2);
+    out = format_char(out, '/');
+    out = format_uint(out, dateTime.date, 2);
+    out = format_char(out, ' ');
+    out = format_uint(out, dateTime.hours, 2);
+    out = format_char(out, ':');
+    out = format_uint(out, dateTime.minutes, 2);
+    out = format_char(out, ':');
+    return format_uint(out, dateTime.seconds, 2);
+}
+
+/**
+ * Writes a "%ld," field of the CSV output
+ */
+char *formatCSV(char *out, int32_t value)
+{
+    out = format_int(out, value, 1);
+    return format_char(out, ',');
+}
+
+/**
+ * Writes "Min\tAvg\tMax\r\n" of a telemetry statistic
+ */
+char *formatStatistics(char *out, int16_t *values, uint8_t decimals)
+{
+    out = format_fixed(out, values[MIN_INDEX], decimals);
+    out = format_char(out, '\t');
+    out = format_fixed(out, values[AVG_INDEX], decimals);
+    out = format_char(out, '\t');
+    out = format_fixed(out, values[MAX_INDEX], decimals);
+    return format_str(out, "\r\n");
+}
+
 void printStatus()
 {
     //Get current FRAM telemetry to get the general statistics of the sensors
@@ -900,75 +1250,103 @@ void printStatus()
     returnCurrentTMLines(tmLines);
     struct TelemetryLine askedTMLine = tmLines[0];
 
-    uint64_t uptime = millis_uptime();
-    uint32_t elapsedSeconds = seconds_uptime();
+    uint32_t uptime = millis_uptime();
     uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
+    char *line;
 
     //Put first the general status of the board
     uart_print(UART_DEBUG, "================================\r\n");
-    sprintf(strToPrint_, "Uptime:         %.3fs\r\n", uptime/1000.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    struct RTCDateTime dateTime;
-    convert_from_unixTime(unixtTimeNow, &dateTime);
-    sprintf(strToPrint_, "Time:           20%.2d/%.2d/%.2d %.2d:%.2d:%.2d\r\n",
-            dateTime.year,
-            dateTime.month,
-            dateTime.date,
-            dateTime.hours,
-            dateTime.minutes,
-            dateTime.seconds);
-    uart_print(UART_DEBUG, strToPrint_);
-
-    sprintf(strToPrint_, "State:          %d\r\n", askedTMLine.state);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Substate:       %d\r\n", askedTMLine.sub_state);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Switches:       0x%02X\r\n", askedTMLine.switches_status);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Errors:         0x%04X\r\n", askedTMLine.errors);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "CPU Temp:       %.1fºC\r\n", askedTMLine.temperatures[0]/10.0);
-    uart_print(UART_DEBUG, strToPrint_);
+    line = format_str(strToPrint_, "Uptime:         ");
+    line = format_ufixed(line, (uint32_t)uptime, 3);
+    line = format_str(line, "s\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "Time:           ");
+    line = formatDate(line, unixtTimeNow);
+    line = format_str(line, "\r\n");
+    printLine(line);
+
+    line = format_str(strToPrint_, "State:          ");
+    line = format_uint(line, askedTMLine.state, 1);
+    line = format_str(line, "\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "Substate:       ");
+    line = format_uint(line, askedTMLine.sub_state, 1);
+    line = format_str(line, "\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "Switches:       0x");
+    line = format_hex(line, askedTMLine.switches_status, 2);
+    line = format_str(line, "\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "Errors:         0x");
+    line = format_hex(line, askedTMLine.errors, 4);
+    line = format_str(line, "\r\n");
+    printLine(line);
+    //Overrun/overflow of every port since the FRAM was programmed
+    line = format_str(strToPrint_, "UART lost:     ");
+    uint8_t port;
+    for(port = UART_DEBUG; port <= UART_CAM4; port++)
+    {
+        struct UartStatistics statistics;
+        uart_get_statistics(port, &statistics);
+        line = format_char(line, ' ');
+        line = format_uint(line, statistics.overrunErrors, 1);
+        line = format_char(line, '/');
+        line = format_uint(line, statistics.overflowErrors, 1);
+    }
+    line = format_str(line, "\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "CPU Temp:       ");
+    line = format_fixed(line, askedTMLine.temperatures[0], 1);
+    line = format_str(line, "ºC\r\n");
+    printLine(line);
     //Then start with the sensors
-    sprintf(strToPrint_, "Pressure:       %.2fmbar\r\n", askedTMLine.pressure/100.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    //sprintf(strToPrint_, "Altitude:       %.2fm\r\n", askedTMLine.altitude/100.0);
-    sprintf(strToPrint_, "Altitude:       %.2fm\r\n", getAltitude()/100.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    //sprintf(strToPrint_, "Altitudi:       %ldm\r\n", getAltitude()/100L);
-    //uart_print(UART_DEBUG, strToPrint_);
-    int32_t speed = getVerticalSpeed();
-    sprintf(strToPrint_, "Current Speed:  %.3fm/s\r\n", (float)speed / 100.0);
-    uart_print(UART_DEBUG, strToPrint_);
+    line = format_str(strToPrint_, "Pressure:       ");
+    line = format_fixed(line, askedTMLine.pressure, 2);
+    line = format_str(line, "mbar\r\n");
+    printLine(line);
+    line = format_str(strToPrint_, "Altitude:       ");
+    line = format_fixed(line, getAltitude(), 2);
+    line = format_str(line, "m\r\n");
+    printLine(line);
+    //Speed is in cm/s, so the third decimal is always 0
+    line = format_str(strToPrint_, "Current Speed:  ");
+    line = format_fixed(line, getVerticalSpeed(), 2);
+    line = format_str(line, "0m/s\r\n");
+    printLine(line);
     //Sunrise GPIO
     uart_print(UART_DEBUG, "Sunrise GPIO:   ");
     if(askedTMLine.switches_status & BIT6)
         uart_print(UART_DEBUG, "HIGH\r\n");
     else
         uart_print(UART_DEBUG, "LOW\r\n");
-    sprintf(strToPrint_, "Temp CPU:       %.1fºC\r\n", askedTMLine.temperatures[0]/10.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Temp [1]:       %.1fºC\r\n", askedTMLine.temperatures[1]/10.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Temp [2]:       %.1fºC\r\n", askedTMLine.temperatures[2]/10.0);
-    uart_print(UART_DEBUG, strToPrint_);
+    uint8_t i;
+    for(i = 0; i < TEMPERATURESENSORS_COUNT; i++)
+    {
+        if(i == 0)
+            line = format_str(strToPrint_, "Temp CPU:       ");
+        else
+        {
+            line = format_str(strToPrint_, "Temp [");
+            line = format_uint(line, i, 1);
+            line = format_str(line, "]:       ");
+        }
+        line = format_fixed(line, askedTMLine.temperatures[i], 1);
+        line = format_str(line, "ºC\r\n");
+        printLine(line);
+    }
     uart_print(UART_DEBUG, "Statistics:\r\n                Min\tAvg\tMax\r\n");
-    sprintf(strToPrint_, "Speed(m/s):     %.2f\t%.2f\t%.2f\r\n",
-            askedTMLine.verticalSpeed[2]/100.0,
-            askedTMLine.verticalSpeed[0]/100.0,
-            askedTMLine.verticalSpeed[1]/100.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Battery(V):     %.2f\t%.2f\t%.2f\r\n",
-            askedTMLine.voltage[2]/100.0,
-            askedTMLine.voltage[0]/100.0,
-            askedTMLine.voltage[1]/100.0);
-    uart_print(UART_DEBUG, strToPrint_);
-    sprintf(strToPrint_, "Battery(mA):    %d\t%d\t%d\r\n",
-            askedTMLine.current[2],
-            askedTMLine.current[0],
-            askedTMLine.current[1]);
-    uart_print(UART_DEBUG, strToPrint_);
-
+    line = format_str(strToPrint_, "Speed(m/s):     ");
+    line = formatStatistics(line, askedTMLine.verticalSpeed, 2);
+    printLine(line);
+    line = format_str(strToPrint_, "Battery(V):     ");
+    line = formatStatistics(line, askedTMLine.voltage, 2);
+    printLine(line);
+    line = format_str(strToPrint_, "Battery(mA):    ");
+    line = formatStatistics(line, askedTMLine.current, 0);
+    printLine(line);
+
+    //Accelerations are kept with sprintf: values are /1000 and rounded to two
+    //decimals, and only the float rounding of printf gives the same output.
     sprintf(strToPrint_, "AccX(g):        %.2f\t%.2f\t%.2f\r\n",
             askedTMLine.accXAxis[2]/1000.0,
             askedTMLine.accXAxis[0]/1000.0,
@@ -1199,6 +1577,10 @@ void processMemoryCommand(char * command)
                     struct TelemetryLine readTelemetry;
                     struct EventLine readEvent;
                     uint32_t i;
+                    char *line;
+                    uint32_t readStart = millis_uptime();
+                    struct UartStatistics statisticsStart;
+                    uart_get_statistics(UART_DEBUG, &statisticsStart);
                     for (i = lineStart; i < lineStart + linesToRead; i++)
                     {
                         //Kick WDT
@@ -1229,83 +1611,94 @@ void processMemoryCommand(char * command)
 
                         if (lineType == MEM_LINE_TLM)
                         {
-                            struct RTCDateTime dateTime;
-                            convert_from_unixTime(readTelemetry.unixTime, &dateTime);
-                            sprintf(strToPrint_, "%ld,20%.2d/%.2d/%.2d %.2d:%.2d:%.2d,",
-                                    i,
-                                    dateTime.year,
-                                    dateTime.month,
-                                    dateTime.date,
-                                    dateTime.hours,
-                                    dateTime.minutes,
-                                    dateTime.seconds);
-                            uart_print(UART_DEBUG, strToPrint_);
-                            sprintf(strToPrint_, "%ld,%ld,%ld,%ld,%d,%d,"
-                                    "%d,%d,%d,%d,",
-                                    readTelemetry.unixTime,
-                                    readTelemetry.upTime,
-                                    readTelemetry.pressure,
-                                    readTelemetry.altitude,
-                                    readTelemetry.verticalSpeed[0],
-                                    readTelemetry.verticalSpeed[1],
-                                    readTelemetry.verticalSpeed[2],
-                                    readTelemetry.temperatures[0],
-                                    readTelemetry.temperatures[1],
-                                    readTelemetry.temperatures[2]/*,
-                                    readTelemetry.temperatures[3],
-                                    readTelemetry.temperatures[4]*/);
-                            uart_print(UART_DEBUG, strToPrint_);
-                            sprintf(strToPrint_, "%d,%d,%d,%d,%d,"
-                                    "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,"
-                                    "%d,0x%02X,0x%04X\r\n",
-                                    readTelemetry.accXAxis[0],
-                                    readTelemetry.accXAxis[1],
-                                    readTelemetry.accXAxis[2],
-                                    readTelemetry.accYAxis[0],
-                                    readTelemetry.accYAxis[1],
-                                    readTelemetry.accYAxis[2],
-                                    readTelemetry.accZAxis[0],
-                                    readTelemetry.accZAxis[1],
-                                    readTelemetry.accZAxis[2],
-                                    readTelemetry.voltage[0],
-                                    readTelemetry.voltage[1],
-                                    readTelemetry.voltage[2],
-                                    readTelemetry.current[0],
-                                    readTelemetry.current[1],
-                                    readTelemetry.current[2],
-                                    readTelemetry.state,
-                                    readTelemetry.sub_state,
-                                    readTelemetry.switches_status,
-                                    readTelemetry.errors);
-                            uart_print(UART_DEBUG, strToPrint_);
+                            line = format_int(strToPrint_, i, 1);
+                            line = format_char(line, ',');
+                            line = formatDate(line, readTelemetry.unixTime);
+                            line = format_char(line, ',');
+                            line = formatCSV(line, readTelemetry.unixTime);
+                            line = formatCSV(line, readTelemetry.upTime);
+                            line = formatCSV(line, readTelemetry.pressure);
+                            line = formatCSV(line, readTelemetry.altitude);
+                            line = formatCSV(line, readTelemetry.verticalSpeed[0]);
+                            line = formatCSV(line, readTelemetry.verticalSpeed[1]);
+                            line = formatCSV(line, readTelemetry.verticalSpeed[2]);
+                            line = formatCSV(line, readTelemetry.temperatures[0]);
+                            line = formatCSV(line, readTelemetry.temperatures[1]);
+                            line = formatCSV(line, readTelemetry.temperatures[2]);
+                            printLine(line);
+                            line = formatCSV(strToPrint_, readTelemetry.accXAxis[0]);
+                            line = formatCSV(line, readTelemetry.accXAxis[1]);
+                            line = formatCSV(line, readTelemetry.accXAxis[2]);
+                            line = formatCSV(line, readTelemetry.accYAxis[0]);
+                            line = formatCSV(line, readTelemetry.accYAxis[1]);
+                            line = formatCSV(line, readTelemetry.accYAxis[2]);
+                            line = formatCSV(line, readTelemetry.accZAxis[0]);
+                            line = formatCSV(line, readTelemetry.accZAxis[1]);
+                            line = formatCSV(line, readTelemetry.accZAxis[2]);
+                            line = formatCSV(line, readTelemetry.voltage[0]);
+                            line = formatCSV(line, readTelemetry.voltage[1]);
+                            line = formatCSV(line, readTelemetry.voltage[2]);
+                            line = formatCSV(line, readTelemetry.current[0]);
+                            line = formatCSV(line, readTelemetry.current[1]);
+                            line = formatCSV(line, readTelemetry.current[2]);
+                            line = formatCSV(line, readTelemetry.state);
+                            line = formatCSV(line, readTelemetry.sub_state);
+                            line = format_str(line, "0x");
+                            line = format_hex(line, readTelemetry.switches_status, 2);
+                            line = format_str(line, ",0x");
+                            line = format_hex(line, readTelemetry.errors, 4);
+                            line = format_str(line, "\r\n");
+                            printLine(line);
                         }
                         else if (lineType == MEM_LINE_EVENT)
                         {
-                            struct RTCDateTime dateTime;
-                            convert_from_unixTime(readEvent.unixTime, &dateTime);
-                            sprintf(strToPrint_, "%ld,20%.2d/%.2d/%.2d %.2d:%.2d:%.2d,",
-                                    i,
-                                    dateTime.year,
-                                    dateTime.month,
-                                    dateTime.date,
-                                    dateTime.hours,
-                                    dateTime.minutes,
-                                    dateTime.seconds);
-                            uart_print(UART_DEBUG, strToPrint_);
-                            sprintf(strToPrint_, "%ld,%ld,%d,%d,%d,%d,%d,%d,%d,%d\r\n",
-                                       readEvent.unixTime,
-                                       readEvent.upTime,
-                                       readEvent.state,
-                                       readEvent.sub_state,
-                                       readEvent.event,
-                                       readEvent.payload[0],
-                                       readEvent.payload[1],
-                                       readEvent.payload[2],
-                                       readEvent.payload[3],
-                                       readEvent.payload[4]);
-                            uart_print(UART_DEBUG, strToPrint_);
+                            line = format_int(strToPrint_, i, 1);
+                            line = format_char(line, ',');
+                            line = formatDate(line, readEvent.unixTime);
+                            line = format_char(line, ',');
+                            line = formatCSV(line, readEvent.unixTime);
+                            line = formatCSV(line, readEvent.upTime);
+                            line = formatCSV(line, readEvent.state);
+                            line = formatCSV(line, readEvent.sub_state);
+                            line = formatCSV(line, readEvent.event);
+                            line = formatCSV(line, readEvent.payload[0]);
+                            line = formatCSV(line, readEvent.payload[1]);
+                            line = formatCSV(line, readEvent.payload[2]);
+                            line = formatCSV(line, readEvent.payload[3]);
+                            line = format_int(line, readEvent.payload[4], 1);
+                            line = format_str(line, "\r\n");
+                            printLine(line);
                         }
                     }
+
+                    //Benchmark of the output, only on verbose mode to not
+                    //break the CSV
+                    if (confRegister_.debugUART == 5)
+                    {
+                        uint32_t elapsed = MS_ELAPSED(readStart, millis_uptime());
+                        if (elapsed == 0)
+                            elapsed = 1;
+                        line = format_str(strToPrint_, "# ");
+                        line = format_uint(line, linesToRead, 1);
+                        line = format_str(line, " lines in ");
+                        line = format_uint(line, elapsed, 1);
+                        line = format_str(line, " ms, ");
+                        line = format_uint(line, (uint32_t)linesToRead * 1000UL / elapsed, 1);
+                        line = format_str(line, " lines/s\r\n");
+                        printLine(line);
+
+                        //Load of the UART engine during the output
+                        struct UartStatistics statisticsEnd;
+                        uart_get_statistics(UART_DEBUG, &statisticsEnd);
+                        line = format_str(strToPrint_, "# TX interrupts ");
+                        line = format_uint(line, statisticsEnd.txInterrupts - statisticsStart.txInterrupts, 1);
+                        line = format_str(line, ", DMA blocks ");
+                        line = format_uint(line, statisticsEnd.dmaTransfers - statisticsStart.dmaTransfers, 1);
+                        line = format_str(line, ", waits on full buffer ");
+                        line = format_uint(line, statisticsEnd.txBufferFull - statisticsStart.txBufferFull, 1);
+                        line = format_str(line, "\r\n");
+                        printLine(line);
+                    }
                 }
 
             }
@@ -1592,347 +1985,404 @@ int8_t terminal_start(void)
     return 0;
 }
 
-// PUBLIC FUNCTIONS
+// COMMAND HANDLERS, one per first word of the command line
 
-uint8_t bufferSizeNow_ = 0;
-uint8_t bufferSizeTotal_ = 0;
-uint8_t command_[CMD_MAX_LEN] = {0};
+void commandHelp(char * command)
+{
+    uart_print(UART_DEBUG, "More detailed information at: "
+            "https://github.com/bultza/IRIS2-firmware-flight/blob/main/README.md\r\n");
+    uart_print(UART_DEBUG, "Available commands:\r\n");
+    uart_print(UART_DEBUG, "  help\r\n");
+    uart_print(UART_DEBUG, "  status\r\n");
+    uart_print(UART_DEBUG, "  reboot\r\n");
+    uart_print(UART_DEBUG, "  conf\r\n");
+    uart_print(UART_DEBUG, "  conf set [parameter] [value]\r\n");
+    uart_print(UART_DEBUG, "  uptime\r\n");
+    uart_print(UART_DEBUG, "  unixtime\r\n");
+    uart_print(UART_DEBUG, "  date\r\n");
+    uart_print(UART_DEBUG, "  date [YYYY/MM/DD HH:mm:ss]\r\n");
+    uart_print(UART_DEBUG, "  i2c rtc\r\n");
+    uart_print(UART_DEBUG, "  i2c temp\r\n");
+    uart_print(UART_DEBUG, "  i2c baro\r\n");
+    uart_print(UART_DEBUG, "  i2c ina\r\n");
+    uart_print(UART_DEBUG, "  i2c acc\r\n");
+    uart_print(UART_DEBUG, "  camera [x] pic\r\n");
+    uart_print(UART_DEBUG, "  camera [x] vid [sec]\r\n");
+    uart_print(UART_DEBUG, "  camera [x] interrupt\r\n");
+    uart_print(UART_DEBUG, "  camera [x] on\r\n");
+    uart_print(UART_DEBUG, "  camera [x] picture_mode\r\n");
+    uart_print(UART_DEBUG, "  camera [x] video_mode\r\n");
+    uart_print(UART_DEBUG, "  camera [x] pic_raw\r\n");
+    uart_print(UART_DEBUG, "  camera [x] format\r\n");
+    uart_print(UART_DEBUG, "  camera [x] video_start\r\n");
+    uart_print(UART_DEBUG, "  camera [x] video_end\r\n");
+    uart_print(UART_DEBUG, "  camera [x] send_cmd [y]\r\n");
+    uart_print(UART_DEBUG, "  camera [x] off\r\n");
+    uart_print(UART_DEBUG, "  p [x]\r\n");
+    uart_print(UART_DEBUG, "  tm nor\r\n");
+    uart_print(UART_DEBUG, "  tm fram\r\n");
+    uart_print(UART_DEBUG, "  memory status\r\n");
+    uart_print(UART_DEBUG, "  memory dump [nor/fram] [start] [end]\r\n");
+    uart_print(UART_DEBUG, "  memory read [nor/fram] [tlm/events] [start] [end]\r\n");
+    uart_print(UART_DEBUG, "  memory erase [nor/fram] bulk\r\n");
+    uart_print(UART_DEBUG, "  uartdebug [uart number]\r\n");
+    uart_print(UART_DEBUG, "  baud [115200/230400/460800/921600]\r\n");
+    uart_print(UART_DEBUG, "  u [data]\r\n");
+    uart_print(UART_DEBUG, "  sched\r\n");
+    uart_print(UART_DEBUG, "  sched reset\r\n");
+    uart_print(UART_DEBUG, "  power\r\n");
+    uart_print(UART_DEBUG, "  perf\r\n");
+    uart_print(UART_DEBUG, "  perf reset\r\n");
+    uart_print(UART_DEBUG, "  clock\r\n");
+    uart_print(UART_DEBUG, "  clock [1/8/16]\r\n");
+}
 
-/**
- * Reads if there is any awaiting command in the UART DEBUG buffer.
- * If so, processes it and acts accordingly.
- */
-int8_t terminal_readAndProcessCommands(void)
+void commandReboot(char * command)
 {
-    uint8_t commandArrived = 0;
+    strcpy(strToPrint_, "System will reboot...\r\n");
+    uart_print(UART_DEBUG, strToPrint_);
+    sleep_ms(500);
+    //Perform a PUC reboot
+    WDTCTL = 0xDEAD;
+}
 
-    // If there is something in the buffer
-    bufferSizeNow_ = uart_available(UART_DEBUG);
-    if (bufferSizeNow_ > 0)
+void commandUartDebug(char * command)
+{
+    if(command[10] == '1')
     {
-        // Let's retrieve char by char
-        uint8_t charRead = uart_read(UART_DEBUG);
+        confRegister_.debugUART = 1;
+        uart_init(1, BR_57600);
+    }
+    else if(command[10] == '2')
+    {
+        confRegister_.debugUART = 2;
+        uart_init(2, BR_57600);
+    }
+    else if(command[10] == '3')
+    {
+        confRegister_.debugUART = 3;
+        uart_init(3, BR_57600);
+    }
+    else if(command[10] == '4')
+    {
+        confRegister_.debugUART = 4;
+        uart_init(4, BR_57600);
+    }
+    else if(command[10] == '5')
+    {
+        confRegister_.debugUART = 5;
+        //This is just to show extra gopro thingies
+    }
+    else
+        confRegister_.debugUART = 0;
 
-        // Filter out for only ASCII chars
-        if ((uint8_t) charRead >= 32 && (uint8_t) charRead < 127)
-        {
-            // Build command
-            command_[bufferSizeTotal_] = charRead;
-            bufferSizeTotal_++;
-            uart_write(UART_DEBUG, &charRead, 1); //print echo
-        }
-        else if(charRead == 0x08 || charRead == 127)   //Backspace!!
-        {
-            //Delete the last character
-            if(bufferSizeTotal_ != 0)
-            {
-                bufferSizeTotal_--;
-                uart_write(UART_DEBUG, &charRead, 1); //print echo
-            }
-        }
-        else if(charRead == '\n' || charRead == '\r')
-        {
-            commandArrived = 1;
-            command_[bufferSizeTotal_] = '\0';  //End of string
-            strToPrint_[0] = '\r';
-            strToPrint_[1] = '\n';
-            strToPrint_[2] = '\0';
-            uart_print(UART_DEBUG, strToPrint_); //print echo
-        }
+    sprintf(strToPrint_, "UART debug changed to camera: %d\r\n",
+            confRegister_.debugUART);
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+void commandUartSend(char * command)
+{
+    //"u" alone is not a command, it needs "u [data]"
+    if(strlen(command) < 3 || command[1] != ' ')
+    {
+        sprintf(strToPrint_, "Command %s is not recognised.\r\n", command);
+        uart_print(UART_DEBUG, strToPrint_);
+        return;
     }
+    char *pointer;
+    pointer = &command[2];
+    uart_print(confRegister_.debugUART, pointer);
+    uart_print(confRegister_.debugUART, "\n");
+}
 
-    //detecting keystrokes from the arrows:
-    if(bufferSizeTotal_ >= 2 &&
-            command_[bufferSizeTotal_ - 2] == '[')
+void commandPressButton(char * command)
+{
+    //"p" alone is not a command, it needs "p [x]"
+    if(strlen(command) < 3 || command[1] != ' ')
     {
-        if(command_[bufferSizeTotal_ - 1] == 'A')
-        {
-            //Up!
-            //Clean line:
-            strToPrint_[0] = '\r';
-            strToPrint_[1] = '\0';
-            uart_print(UART_DEBUG, strToPrint_); //put cursor on start
-            uart_print(UART_DEBUG, "                              "); //Clean
-            uart_print(UART_DEBUG, "                              "); //Clean
-            uart_print(UART_DEBUG, strToPrint_); //put cursor on start
-            //print terminal:
-            //uart_print(UART_DEBUG,"IRIS:/# ");
-            uart_print(UART_DEBUG,"# ");
-            //print selected command:
-            sprintf(strToPrint_, "%s", commandHistory_[cmdSelector_]);
-            uart_print(UART_DEBUG, strToPrint_);
-            //Copy the command:
-            strcpy((char *)command_, commandHistory_[cmdSelector_]);
-            bufferSizeTotal_ = strlen((char *)command_);
+        sprintf(strToPrint_, "Command %s is not recognised.\r\n", command);
+        uart_print(UART_DEBUG, strToPrint_);
+        return;
+    }
 
-            if (cmdSelector_ > 0)
-                cmdSelector_--;
-        }
-        else if(command_[bufferSizeTotal_ - 1] == 'B')
-        {
-            if (cmdSelector_ < numIssuedCommands_-1 && cmdSelector_ < CMD_MAX_SAVE-1)
-                cmdSelector_++;
-
-            //Down!
-            //Clean line:
-            strToPrint_[0] = '\r';
-            strToPrint_[1] = '\0';
-            uart_print(UART_DEBUG, strToPrint_); //put cursor on start
-            uart_print(UART_DEBUG, "                              "); //Clean
-            uart_print(UART_DEBUG, "                              "); //Clean
-            uart_print(UART_DEBUG, strToPrint_); //put cursor on start
-            //print terminal:
-            uart_print(UART_DEBUG,"# ");;
-            //print selected command:
-            sprintf(strToPrint_, "%s", commandHistory_[cmdSelector_]);
-            uart_print(UART_DEBUG, strToPrint_);
-            //Copy the command:
-            strcpy((char *)command_, commandHistory_[cmdSelector_]);
-            bufferSizeTotal_ = strlen((char *)command_);
-        }
-        //Ignore any others for the moment
+    if(command[2] == '1')
+    {
+        P7OUT &= ~BIT5;     // Put output bit to 0
+        P7DIR |= BIT5;      // Define button as output
+        sleep_ms(250);
+        P7DIR &= ~BIT5;      // Define button as input - high impedance
+    }
+    else if(command[2] == '2')
+    {
+        P7OUT &= ~BIT6;     // Put output bit to 0
+        P7DIR |= BIT6;      // Define button as output
+        sleep_ms(250);
+        P7DIR &= ~BIT6;      // Define button as input - high impedance
+    }
+    else if(command[2] == '3')
+    {
+        P7OUT &= ~BIT7;     // Put output bit to 0
+        P7DIR |= BIT7;      // Define button as output
+        sleep_ms(250);
+        P7DIR &= ~BIT7;      // Define button as input - high impedance
+    }
+    else if(command[2] == '4')
+    {
+        P5OUT &= ~BIT6;     // Put output bit to 0
+        P5DIR |= BIT6;      // Define button as output
+        sleep_ms(250);
+        P5DIR &= ~BIT6;      // Define button as input - high impedance
     }
 
-    // If a command arrived and was composed
-    if (commandArrived && beginFlag_ == 1)
+    sprintf(strToPrint_, "Button of camera %c pressed\r\n",
+            command[2]);
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+void commandUptime(char * command)
+{
+    uint32_t uptime = seconds_uptime();
+    sprintf(strToPrint_, "Uptime is %ld s\r\n", uptime);
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+void commandUnixtime(char * command)
+{
+    uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
+    sprintf(strToPrint_, "%ld\r\n", unixtTimeNow);
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+void commandDate(char * command)
+{
+    if (strcmp("date", command) == 0)
     {
-        // Interpret command
-        if (command_[0] == 0)
-        {
-            //Empty command, nothing to do, print again the commandline
-        }
-        else if (strcmp("help", (char *)command_) == 0)
-        {
-            uart_print(UART_DEBUG, "More detailed information at: "
-                    "https://github.com/bultza/IRIS2-firmware-flight/blob/main/README.md\r\n");
-            uart_print(UART_DEBUG, "Available commands:\r\n");
-            uart_print(UART_DEBUG, "  help\r\n");
-            uart_print(UART_DEBUG, "  status\r\n");
-            uart_print(UART_DEBUG, "  reboot\r\n");
-            uart_print(UART_DEBUG, "  conf\r\n");
-            uart_print(UART_DEBUG, "  conf set [parameter] [value]\r\n");
-            uart_print(UART_DEBUG, "  uptime\r\n");
-            uart_print(UART_DEBUG, "  unixtime\r\n");
-            uart_print(UART_DEBUG, "  date\r\n");
-            uart_print(UART_DEBUG, "  date [YYYY/MM/DD HH:mm:ss]\r\n");
-            uart_print(UART_DEBUG, "  i2c rtc\r\n");
-            uart_print(UART_DEBUG, "  i2c temp\r\n");
-            uart_print(UART_DEBUG, "  i2c baro\r\n");
-            uart_print(UART_DEBUG, "  i2c ina\r\n");
-            uart_print(UART_DEBUG, "  i2c acc\r\n");
-            uart_print(UART_DEBUG, "  camera [x] pic\r\n");
-            uart_print(UART_DEBUG, "  camera [x] vid [sec]\r\n");
-            uart_print(UART_DEBUG, "  camera [x] interrupt\r\n");
-            uart_print(UART_DEBUG, "  camera [x] on\r\n");
-            uart_print(UART_DEBUG, "  camera [x] picture_mode\r\n");
-            uart_print(UART_DEBUG, "  camera [x] video_mode\r\n");
-            uart_print(UART_DEBUG, "  camera [x] pic_raw\r\n");
-            uart_print(UART_DEBUG, "  camera [x] format\r\n");
-            uart_print(UART_DEBUG, "  camera [x] video_start\r\n");
-            uart_print(UART_DEBUG, "  camera [x] video_end\r\n");
-            uart_print(UART_DEBUG, "  camera [x] send_cmd [y]\r\n");
-            uart_print(UART_DEBUG, "  camera [x] off\r\n");
-            uart_print(UART_DEBUG, "  p [x]\r\n");
-            uart_print(UART_DEBUG, "  tm nor\r\n");
-            uart_print(UART_DEBUG, "  tm fram\r\n");
-            uart_print(UART_DEBUG, "  memory status\r\n");
-            uart_print(UART_DEBUG, "  memory dump [nor/fram] [start] [end]\r\n");
-            uart_print(UART_DEBUG, "  memory read [nor/fram] [tlm/events] [start] [end]\r\n");
-            uart_print(UART_DEBUG, "  memory erase [nor/fram] bulk\r\n");
-            uart_print(UART_DEBUG, "  uartdebug [uart number]\r\n");
-            uart_print(UART_DEBUG, "  u [data]\r\n");
-        }
-        else if (strncmp("terminal", (char *)command_, 8) == 0)
-        {
-            processTerminalCommand((char *) command_);
-        }
-        else if (strcmp("reboot", (char *)command_) == 0)
-        {
-            strcpy(strToPrint_, "System will reboot...\r\n");
-            uart_print(UART_DEBUG, strToPrint_);
-            sleep_ms(500);
-            //Perform a PUC reboot
-            WDTCTL = 0xDEAD;
-        }
-        else if (strncmp("uartdebug", (char *)command_, 9) == 0)
-        {
-            if(command_[10] == '1')
-            {
-                confRegister_.debugUART = 1;
-                uart_init(1, BR_57600);
-            }
-            else if(command_[10] == '2')
-            {
-                confRegister_.debugUART = 2;
-                uart_init(2, BR_57600);
-            }
-            else if(command_[10] == '3')
-            {
-                confRegister_.debugUART = 3;
-                uart_init(3, BR_57600);
-            }
-            else if(command_[10] == '4')
-            {
-                confRegister_.debugUART = 4;
-                uart_init(4, BR_57600);
-            }
-            else if(command_[10] == '5')
-            {
-                confRegister_.debugUART = 5;
-                //This is just to show extra gopro thingies
-            }
-            else
-                confRegister_.debugUART = 0;
+        uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
+        struct RTCDateTime dateTime;
+        convert_from_unixTime(unixtTimeNow, &dateTime);
+        sprintf(strToPrint_, "Date is: 20%.2d/%.2d/%.2d %.2d:%.2d:%.2d\r\n",
+                dateTime.year,
+                dateTime.month,
+                dateTime.date,
+                dateTime.hours,
+                dateTime.minutes,
+                dateTime.seconds);
+        uart_print(UART_DEBUG, strToPrint_);
+        return;
+    }
 
-            sprintf(strToPrint_, "UART debug changed to camera: %d\r\n",
-                    confRegister_.debugUART);
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strncmp("u ", (char *)command_, 2) == 0)
-        {
-            uint8_t *pointer;
-            pointer = &command_[2];
-            uart_print(confRegister_.debugUART, (char *)pointer);
-            uart_print(confRegister_.debugUART, "\n");
-        }
-        else if (strncmp("p ", (char *)command_, 2) == 0)
-        {
-            if(command_[2] == '1')
-            {
-                P7OUT &= ~BIT5;     // Put output bit to 0
-                P7DIR |= BIT5;      // Define button as output
-                sleep_ms(250);
-                P7DIR &= ~BIT5;      // Define button as input - high impedance
-            }
-            else if(command_[2] == '2')
-            {
-                P7OUT &= ~BIT6;     // Put output bit to 0
-                P7DIR |= BIT6;      // Define button as output
-                sleep_ms(250);
-                P7DIR &= ~BIT6;      // Define button as input - high impedance
-            }
-            else if(command_[2] == '3')
-            {
-                P7OUT &= ~BIT7;     // Put output bit to 0
-                P7DIR |= BIT7;      // Define button as output
-                sleep_ms(250);
-                P7DIR &= ~BIT7;      // Define button as input - high impedance
-            }
-            else if(command_[2] == '4')
-            {
-                P5OUT &= ~BIT6;     // Put output bit to 0
-                P5DIR |= BIT6;      // Define button as output
-                sleep_ms(250);
-                P5DIR &= ~BIT6;      // Define button as input - high impedance
-            }
+    //date YYYY/MM/DD HH:mm:ss
+    if(strlen(command) != 24
+            || command[9] != '/'
+            || command[12] != '/'
+            || command[15] != ' '
+            || command[18] != ':'
+            || command[21] != ':')
+        strcpy(strToPrint_, "Incorrect command, usage is: date YYYY/MM/DD HH:mm:ss\r\n");
+    else
+    {
+        struct RTCDateTime dateTime;
+        char *pointer;
+        pointer = &command[7];
+        command[9] = '\0';     //End of word
+        command[12] = '\0';     //End of word
+        command[15] = '\0';     //End of word
+        command[18] = '\0';     //End of word
+        command[21] = '\0';     //End of word
+        dateTime.year = atoi(pointer);
+        pointer = &command[10];
+        dateTime.month = atoi(pointer);
+        pointer = &command[13];
+        dateTime.date = atoi(pointer);
+        pointer = &command[16];
+        dateTime.hours = atoi(pointer);
+        pointer = &command[19];
+        dateTime.minutes = atoi(pointer);
+        pointer = &command[22];
+        dateTime.seconds = atoi(pointer);
+        uint32_t unixTime = convert_to_unixTime(dateTime);
+        i2c_RTC_set_unixTime(unixTime);
+
+        sprintf(strToPrint_, "Date changed to: 20%.2d/%.2d/%.2d %.2d:%.2d:%.2d\r\n",
+                            dateTime.year,
+                            dateTime.month,
+                            dateTime.date,
+                            dateTime.hours,
+                            dateTime.minutes,
+                            dateTime.seconds);
+    }
+    uart_print(UART_DEBUG, strToPrint_);
+}
 
-            sprintf(strToPrint_, "Button of camera %c pressed\r\n",
-                    command_[2]);
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strcmp("uptime", (char *)command_) == 0)
-        {
-            uint32_t uptime = seconds_uptime();
-            sprintf(strToPrint_, "Uptime is %ld s\r\n", uptime);
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strcmp("unixtime", (char *)command_) == 0)
-        {
-            uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
-            sprintf(strToPrint_, "%ld\r\n", unixtTimeNow);
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strcmp("date", (char *)command_) == 0)
-        {
-            uint32_t unixtTimeNow = i2c_RTC_unixTime_now();
-            struct RTCDateTime dateTime;
-            convert_from_unixTime(unixtTimeNow, &dateTime);
-            sprintf(strToPrint_, "Date is: 20%.2d/%.2d/%.2d %.2d:%.2d:%.2d\r\n",
-                    dateTime.year,
-                    dateTime.month,
-                    dateTime.date,
-                    dateTime.hours,
-                    dateTime.minutes,
-                    dateTime.seconds);
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strncmp("date", (char *)command_, 4) == 0)
-        {
-            //date YYYY/MM/DD HH:mm:ss
-            if(strlen((char *)command_) != 24
-                    || command_[9] != '/'
-                    || command_[12] != '/'
-                    || command_[15] != ' '
-                    || command_[18] != ':'
-                    || command_[21] != ':')
-                strcpy(strToPrint_, "Incorrect command, usage is: date YYYY/MM/DD HH:mm:ss\r\n");
-            else
-            {
-                struct RTCDateTime dateTime;
-                uint8_t *pointer;
-                pointer = &command_[7];
-                command_[9] = '\0';     //End of word
-                command_[12] = '\0';     //End of word
-                command_[15] = '\0';     //End of word
-                command_[18] = '\0';     //End of word
-                command_[21] = '\0';     //End of word
-                dateTime.year = atoi((char *)pointer);
-                pointer = &command_[10];
-                dateTime.month = atoi((char *)pointer);
-                pointer = &command_[13];
-                dateTime.date = atoi((char *)pointer);
-                pointer = &command_[16];
-                dateTime.hours = atoi((char *)pointer);
-                pointer = &command_[19];
-                dateTime.minutes = atoi((char *)pointer);
-                pointer = &command_[22];
-                dateTime.seconds = atoi((char *)pointer);
-                uint32_t unixTime = convert_to_unixTime(dateTime);
-                i2c_RTC_set_unixTime(unixTime);
-
-                sprintf(strToPrint_, "Date changed to: 20%.2d/%.2d/%.2d %.2d:%.2d:%.2d\r\n",
-                                    dateTime.year,
-                                    dateTime.month,
-                                    dateTime.date,
-                                    dateTime.hours,
-                                    dateTime.minutes,
-                                    dateTime.seconds);
-            }
-            uart_print(UART_DEBUG, strToPrint_);
-        }
-        else if (strncmp("fsw", (char *) command_, 3) == 0)
-        {
-            processFSWCommand((char *) command_);
-        }
-        else if (strncmp("conf", (char *) command_, 4) == 0)
-        {
-            processConfCommand((char *) command_);
-        }
-        else if(strncmp("i2c", (char *) command_, 3) == 0)
-        {
-            processI2CCommand((char *) command_);
-        }
-        else if (strncmp("camera", (char *)command_, 6) == 0)
-        {
-            processCameraCommand((char *) command_);
-        }
-        else if (strncmp("tm", (char *)command_, 2) == 0)
-        {
-            processTMCommand((char *) command_);
-        }
-        else if (strcmp("status", (char *)command_) == 0)
-        {
-            printStatus();
-        }
-        else if (strncmp("memory", (char *)command_, 6) == 0)
+void commandStatus(char * command)
+{
+    printStatus();
+}
+
+void commandPerf(char * command)
+{
+    if (strcmp("perf reset", command) == 0)
+    {
+        profiler_reset();
+        uart_print(UART_DEBUG, "Profiler statistics cleared\r\n");
+    }
+    else
+        profiler_print();
+}
+
+void commandClock(char * command)
+{
+    if (strcmp("clock", command) == 0)
+    {
+        sprintf(strToPrint_, "Clock at %dMHz, last self-test 0x%.2X\r\n",
+                clock_getMHz(), clock_profile_lastTest());
+        uart_print(UART_DEBUG, strToPrint_);
+        return;
+    }
+
+    uint8_t mhz = atoi(&command[6]);
+    uint8_t profile;
+    for(profile = 0; profile < CLOCK_PROFILE_COUNT; profile++)
+    {
+        if(clock_profileMHz(profile) == mhz)
+            break;
+    }
+    if(profile == CLOCK_PROFILE_COUNT)
+    {
+        uart_print(UART_DEBUG, "Incorrect command, usage is: clock [1/8/16]\r\n");
+        return;
+    }
+
+    int8_t result = clock_profile_set(profile);
+    if(result == -2)
+        strcpy(strToPrint_, "An open UART can not keep its baudrate with that clock\r\n");
+    else if(result == -3)
+        sprintf(strToPrint_, "Self-test failed 0x%.2X, clock at %dMHz\r\n",
+                clock_profile_lastTest(), clock_getMHz());
+    else
+        sprintf(strToPrint_, "Clock changed to %dMHz, self-test OK\r\n",
+                clock_getMHz());
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+void commandPower(char * command)
+{
+    scheduler_printPower();
+}
+
+void commandSched(char * command)
+{
+    if (strcmp("sched reset", command) == 0)
+    {
+        scheduler_resetStats();
+        uart_print(UART_DEBUG, "Scheduler statistics cleared\r\n");
+    }
+    else
+        scheduler_printStats();
+}
+
+struct TerminalCommand
+{
+    const char *name;                   //First word of the command
+    void (*handler)(char * command);    //It receives the full command line
+};
+
+//Sorted alphabetically (strcmp order!) because it is searched by bisection
+static const struct TerminalCommand terminalCommands_[] =
+{
+    {"baud",        processBaudCommand},
+    {"camera",      processCameraCommand},
+    {"clock",       commandClock},
+    {"conf",        processConfCommand},
+    {"date",        commandDate},
+    {"fsw",         processFSWCommand},
+    {"help",        commandHelp},
+    {"i2c",         processI2CCommand},
+    {"memory",      processMemoryCommand},
+    {"p",           commandPressButton},
+    {"perf",        commandPerf},
+    {"power",       commandPower},
+    {"reboot",      commandReboot},
+    {"sched",       commandSched},
+    {"status",      commandStatus},
+    {"terminal",    processTerminalCommand},
+    {"tm",          processTMCommand},
+    {"u",           commandUartSend},
+    {"uartdebug",   commandUartDebug},
+    {"unixtime",    commandUnixtime},
+    {"uptime",      commandUptime},
+};
+
+#define TERMINAL_COMMANDS_COUNT (sizeof(terminalCommands_) / sizeof(terminalCommands_[0]))
+
+/**
+ * It searches the first word of the command in the table of commands and
+ * executes its handler
+ */
+void processCommandLine(char * command)
+{
+    //Extract first word
+    char name[16];
+    uint8_t i = 0;
+    while(command[i] != ' ' && command[i] != '\0' && i < sizeof(name) - 1)
+    {
+        name[i] = command[i];
+        i++;
+    }
+    name[i] = '\0';
+
+    //Bisection on the sorted table
+    int8_t low = 0;
+    int8_t high = TERMINAL_COMMANDS_COUNT - 1;
+    while(low <= high)
+    {
+        int8_t middle = (low + high) / 2;
+        int16_t comparison = strcmp(name, terminalCommands_[middle].name);
+        if(comparison == 0)
         {
-            processMemoryCommand((char *) command_);
+            terminalCommands_[middle].handler(command);
+            return;
         }
+        else if(comparison < 0)
+            high = middle - 1;
         else
+            low = middle + 1;
+    }
+
+    sprintf(strToPrint_, "Command %s is not recognised.\r\n", command);
+    uart_print(UART_DEBUG, strToPrint_);
+}
+
+// PUBLIC FUNCTIONS
+
+uint8_t bufferSizeTotal_ = 0;
+uint8_t command_[CMD_MAX_LEN] = {0};
+
+/**
+ * It runs a complete command line that arrived in command_
+ */
+void terminal_runCommand(void)
+{
+    // Waiting for the handshake of the new baudrate, anything but a clean
+    // "baud ok" means the host is not able to talk to us at this speed
+    if (baudPending_)
+    {
+        if (strcmp("baud ok", (char *)command_) == 0)
         {
-            sprintf(strToPrint_, "Command %s is not recognised.\r\n", (char *)command_);
+            baudPending_ = 0;
+            sprintf(strToPrint_, "Baudrate %ld confirmed\r\n# ",
+                    uart_baudrate_value(uart_get_baudrate(UART_DEBUG)));
             uart_print(UART_DEBUG, strToPrint_);
         }
+        else if (command_[0] != 0)
+            baudFallback();
+    }
+    else if (beginFlag_ == 1)
+    {
+        // Interpret command, if empty nothing to do, print again the commandline
+        if (command_[0] != 0)
+            processCommandLine((char *) command_);
 
         if (beginFlag_ != 0)
         {
@@ -1953,11 +2403,8 @@ int8_t terminal_readAndProcessCommands(void)
             //uart_print(UART_DEBUG,"IRIS:/# ");
             uart_print(UART_DEBUG,"# ");
         }
-
-        bufferSizeNow_ = 0;
-        bufferSizeTotal_ = 0;
     }
-    else if(commandArrived && beginFlag_ == 0)
+    else
     {
         if(strcmp("terminal begin", (char *)command_) == 0)
             terminal_start();
@@ -1966,10 +2413,104 @@ int8_t terminal_readAndProcessCommands(void)
             strcpy(strToPrint_, "Incorrect password...\r\n");
             uart_print(UART_DEBUG, strToPrint_);
         }
+    }
+
+    //Nothing of this line must be seen by the next one
+    memset(command_, 0, CMD_MAX_LEN);
+    bufferSizeTotal_ = 0;
+}
 
-        bufferSizeNow_ = 0;
+/**
+ * It replaces the line being written by the selected command of the history
+ */
+void terminal_recallHistory(void)
+{
+    //Clean line:
+    strToPrint_[0] = '\r';
+    strToPrint_[1] = '\0';
+    uart_print(UART_DEBUG, strToPrint_); //put cursor on start
+    uart_print(UART_DEBUG, "                              "); //Clean
+    uart_print(UART_DEBUG, "                              "); //Clean
+    uart_print(UART_DEBUG, strToPrint_); //put cursor on start
+    //print terminal:
+    //uart_print(UART_DEBUG,"IRIS:/# ");
+    uart_print(UART_DEBUG,"# ");
+    //print selected command:
+    uart_print(UART_DEBUG, commandHistory_[cmdSelector_]);
+    //Copy the command:
+    strcpy((char *)command_, commandHistory_[cmdSelector_]);
+    bufferSizeTotal_ = strlen((char *)command_);
+}
+
+/**
+ * Reads all the awaiting characters in the UART DEBUG buffer.
+ * Every complete command is processed and acts accordingly.
+ */
+int8_t terminal_readAndProcessCommands(void)
+{
+    //New baudrate not confirmed on time?
+    if(baudPending_ && MS_AFTER(millis_uptime(), baudDeadline_))
+    {
+        baudFallback();
         bufferSizeTotal_ = 0;
     }
 
+    // Let's retrieve char by char everything that is in the buffer
+    while (uart_available(UART_DEBUG) > 0)
+    {
+        uint8_t charRead = uart_read(UART_DEBUG);
+
+        // Filter out for only ASCII chars
+        if ((uint8_t) charRead >= 32 && (uint8_t) charRead < 127)
+        {
+            // Build command, if it does not fit just ignore the rest
+            if (bufferSizeTotal_ < CMD_MAX_LEN - 1)
+            {
+                command_[bufferSizeTotal_] = charRead;
+                bufferSizeTotal_++;
+                uart_write(UART_DEBUG, &charRead, 1); //print echo
+            }
+        }
+        else if(charRead == 0x08 || charRead == 127)   //Backspace!!
+        {
+            //Delete the last character
+            if(bufferSizeTotal_ != 0)
+            {
+                bufferSizeTotal_--;
+                uart_write(UART_DEBUG, &charRead, 1); //print echo
+            }
+        }
+        else if(charRead == '\n' || charRead == '\r')
+        {
+            command_[bufferSizeTotal_] = '\0';  //End of string
+            uart_print(UART_DEBUG, "\r\n"); //print echo
+            terminal_runCommand();
+            continue;
+        }
+
+        //detecting keystrokes from the arrows:
+        if(bufferSizeTotal_ >= 2 &&
+                command_[bufferSizeTotal_ - 2] == '[')
+        {
+            if(command_[bufferSizeTotal_ - 1] == 'A')
+            {
+                //Up!
+                terminal_recallHistory();
+
+                if (cmdSelector_ > 0)
+                    cmdSelector_--;
+            }
+            else if(command_[bufferSizeTotal_ - 1] == 'B')
+            {
+                if (cmdSelector_ < numIssuedCommands_-1 && cmdSelector_ < CMD_MAX_SAVE-1)
+                    cmdSelector_++;
+
+                //Down!
+                terminal_recallHistory();
+            }
+            //Ignore any others for the moment
+        }
+    }
+
     return 0;
 }
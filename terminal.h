@@ -22,6 +22,9 @@
 #include "i2c_ADXL345.h"
 #include "datalogger.h"
 #include "gopros.h"
+#include "flight_sequence.h"
+#include "scheduler.h"
+#include "clock_profile.h"
 
 #define CMD_MAX_SAVE 10
 #define CMD_MAX_LEN 100
@@ -38,6 +41,8 @@
 #define MEM_OUTFORMAT_HEX   0
 #define MEM_OUTFORMAT_BIN   1
 
+#define BAUD_CONFIRM_TIMEOUT    10000   //[ms] to confirm a new debug baudrate
+
 int8_t terminal_start(void);
 int8_t terminal_readAndProcessCommands(void);
 
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ * Host benchmark of the ring buffer, bytes per second moved through it with
+ * byte and block accesses. It only compares versions of ringbuffer.c on the
+ * same machine, the MSP430 is orders of magnitude slower.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "../ringbuffer.h"
+
+#define RING_SIZE   2048
+#define TOTAL_BYTES (256UL * 1024UL * 1024UL)
+
+static uint8_t data_[RING_SIZE];
+static uint8_t block_[RING_SIZE];
+static volatile uint8_t sink_;
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static void report(const char *name, uint16_t blockSize, double seconds)
+{
+    printf("%-12s block %4u: %8.1f MB/s\n", name, blockSize,
+           TOTAL_BYTES / seconds / 1e6);
+}
+
+static void benchBytes(void)
+{
+    struct RingBuffer ring;
+    unsigned long moved;
+    uint16_t i;
+    uint8_t byte = 0;
+
+    ring_init(&ring, data_, RING_SIZE);
+    double start = now();
+    for(moved = 0; moved < TOTAL_BYTES; moved += 64)
+    {
+        for(i = 0; i < 64; i++)
+            ring_push(&ring, (uint8_t)i);
+        for(i = 0; i < 64; i++)
+            ring_pop(&ring, &byte);
+    }
+    sink_ = byte;
+    report("push/pop", 1, now() - start);
+}
+
+static void benchBlocks(uint16_t blockSize)
+{
+    struct RingBuffer ring;
+    unsigned long moved;
+
+    ring_init(&ring, data_, RING_SIZE);
+    //Odd offset, so the copies wrap around the end of the buffer
+    ring_push(&ring, 0);
+    double start = now();
+    for(moved = 0; moved < TOTAL_BYTES; moved += blockSize)
+    {
+        ring_write(&ring, block_, blockSize);
+        ring_read(&ring, block_, blockSize);
+    }
+    sink_ = block_[0];
+    report("write/read", blockSize, now() - start);
+
+    ring_init(&ring, data_, RING_SIZE);
+    ring_push(&ring, 0);
+    start = now();
+    for(moved = 0; moved < TOTAL_BYTES; moved += blockSize)
+    {
+        uint8_t *span;
+        ring_write(&ring, block_, blockSize);
+        while(ring_count(&ring) > 1)
+            ring_skip(&ring, ring_span(&ring, &span));
+    }
+    report("write/span", blockSize, now() - start);
+}
+
+int main(void)
+{
+    benchBytes();
+    benchBlocks(16);
+    benchBlocks(64);
+    benchBlocks(512);
+    return 0;
+}
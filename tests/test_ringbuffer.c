@@ -0,0 +1,164 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ *
+ * Host test of the ring buffer: random operations are applied at the same
+ * time to the ring and to a plain array used as a model, and both must always
+ * hold the same bytes. The counters start close to 65536 so they wrap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../ringbuffer.h"
+
+#define MAX_SIZE    512
+#define OPERATIONS  200000
+
+static uint8_t data_[MAX_SIZE];
+static uint8_t model_[MAX_SIZE];
+static uint16_t modelCount_ = 0;
+static uint8_t nextByte_ = 0;
+static unsigned long checks_ = 0;
+static unsigned long failures_ = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(int condition, const char *text, int line)
+{
+    checks_++;
+    if(condition)
+        return;
+    failures_++;
+    if(failures_ < 20)
+        printf("FAIL line %d: %s\n", line, text);
+}
+
+static void modelAdd(const uint8_t *buffer, uint16_t length)
+{
+    memcpy(&model_[modelCount_], buffer, length);
+    modelCount_ += length;
+}
+
+static void modelTake(const uint8_t *buffer, uint16_t length)
+{
+    CHECK(length <= modelCount_);
+    CHECK(memcmp(model_, buffer, length) == 0);
+    memmove(model_, &model_[length], modelCount_ - length);
+    modelCount_ -= length;
+}
+
+static void fill(uint8_t *buffer, uint16_t length)
+{
+    uint16_t i;
+    for(i = 0; i < length; i++)
+        buffer[i] = nextByte_++;
+}
+
+static void testInit(void)
+{
+    struct RingBuffer ring;
+    CHECK(ring_init(&ring, data_, 0) == -1);
+    CHECK(ring_size(&ring) == 0);
+    CHECK(ring_push(&ring, 1) == -1);
+    CHECK(ring_init(&ring, data_, 3) == -1);
+    CHECK(ring_init(&ring, data_, 96) == -1);
+    CHECK(ring_init(&ring, data_, 0xFFFF) == -1);
+    CHECK(ring_init(&ring, data_, 1) == 0);
+    CHECK(ring_size(&ring) == 1);
+    CHECK(ring_init(&ring, data_, 0x8000) == 0);
+    CHECK(ring_size(&ring) == 0x8000);
+}
+
+static void testRandom(uint16_t size)
+{
+    struct RingBuffer ring;
+    uint8_t buffer[MAX_SIZE + 8];
+    long i;
+
+    CHECK(ring_init(&ring, data_, size) == 0);
+    ring.start = ring.end = 0xFFFF - (rand() % (4 * size));
+    modelCount_ = 0;
+
+    for(i = 0; i < OPERATIONS; i++)
+    {
+        uint16_t length = rand() % (size + 4);
+        uint16_t done;
+        uint8_t *span;
+        uint8_t byte;
+
+        switch(rand() % 8)
+        {
+        case 0:     //push
+            fill(&byte, 1);
+            if(ring_push(&ring, byte) == 0)
+                modelAdd(&byte, 1);
+            else
+                CHECK(modelCount_ == size);
+            break;
+        case 1:     //pop
+            if(ring_pop(&ring, &byte) == 0)
+                modelTake(&byte, 1);
+            else
+                CHECK(modelCount_ == 0);
+            break;
+        case 2:     //write
+            fill(buffer, length);
+            done = ring_write(&ring, buffer, length);
+            CHECK(done == (length < size - modelCount_ ? length : size - modelCount_));
+            modelAdd(buffer, done);
+            break;
+        case 3:     //read
+            done = ring_read(&ring, buffer, length);
+            CHECK(done == (length < modelCount_ ? length : modelCount_));
+            modelTake(buffer, done);
+            break;
+        case 4:     //span and skip
+            done = ring_span(&ring, &span);
+            CHECK(done <= modelCount_);
+            CHECK(done == modelCount_ || (span + done) == data_ + size);
+            if(length > done)
+                length = done;
+            memcpy(buffer, span, length);
+            ring_skip(&ring, length);
+            modelTake(buffer, length);
+            break;
+        case 5:     //peek
+            if(modelCount_ != 0)
+            {
+                uint16_t offset = rand() % modelCount_;
+                CHECK(ring_peek(&ring, offset) == model_[offset]);
+            }
+            break;
+        case 6:     //skip more than there is
+            if(rand() % 16 == 0)
+            {
+                ring_skip(&ring, modelCount_ + length);
+                modelCount_ = 0;
+            }
+            break;
+        default:    //clear, rarely
+            if(rand() % 64 == 0)
+            {
+                ring_clear(&ring);
+                modelCount_ = 0;
+            }
+            break;
+        }
+
+        CHECK(ring_count(&ring) == modelCount_);
+        CHECK(ring_free(&ring) == size - modelCount_);
+    }
+}
+
+int main(void)
+{
+    uint16_t size;
+
+    srand(2021);
+    testInit();
+    for(size = 1; size <= MAX_SIZE; size *= 2)
+        testRandom(size);
+
+    printf("%lu checks, %lu failures\n", checks_, failures_);
+    return failures_ != 0;
+}
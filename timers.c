@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#include "timers.h"
+
+struct Timer timers_[TIMER_COUNT];
+uint8_t wheel_[2 * TIMER_WHEEL_SLOTS];  //First timer of every slot, level 0 then 1
+uint32_t wheelNow_ = 0;                 //[tick] last tick served
+
+/*
+ * It takes the timer out of its slot
+ */
+static void timer_unlink(uint8_t id)
+{
+    struct Timer *timer = &timers_[id];
+    if(timer->slot == TIMER_NONE)
+        return;
+    if(timer->prev != TIMER_NONE)
+        timers_[timer->prev].next = timer->next;
+    else
+        wheel_[timer->slot] = timer->next;
+    if(timer->next != TIMER_NONE)
+        timers_[timer->next].prev = timer->prev;
+    timer->slot = TIMER_NONE;
+}
+
+/*
+ * It puts the timer on the slot of its expiry, it must be after wheelNow_
+ */
+static void timer_link(uint8_t id)
+{
+    struct Timer *timer = &timers_[id];
+    uint32_t turns = (timer->expiry >> TIMER_WHEEL_BITS) - (wheelNow_ >> TIMER_WHEEL_BITS);
+    uint8_t slot;
+    if(timer->expiry - wheelNow_ < TIMER_WHEEL_SLOTS)
+        slot = timer->expiry & TIMER_WHEEL_MASK;
+    else if(turns < TIMER_WHEEL_SLOTS)
+        slot = TIMER_WHEEL_SLOTS + ((timer->expiry >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK);
+    else
+        //Too far, it waits on the last slot of level 1
+        slot = TIMER_WHEEL_SLOTS
+            + (((wheelNow_ >> TIMER_WHEEL_BITS) + TIMER_WHEEL_SLOTS - 1) & TIMER_WHEEL_MASK);
+
+    timer->slot = slot;
+    timer->prev = TIMER_NONE;
+    timer->next = wheel_[slot];
+    if(timer->next != TIMER_NONE)
+        timers_[timer->next].prev = id;
+    wheel_[slot] = id;
+}
+
+/**
+ * All timers stopped
+ */
+void timer_init(void)
+{
+    uint8_t i;
+    for(i = 0; i < 2 * TIMER_WHEEL_SLOTS; i++)
+        wheel_[i] = TIMER_NONE;
+    for(i = 0; i < TIMER_COUNT; i++)
+    {
+        timers_[i].running = 0;
+        timers_[i].expired = 0;
+        timers_[i].slot = TIMER_NONE;
+    }
+    wheelNow_ = clock_tick_count();
+}
+
+/**
+ * To be run on every tick, before the tasks using the timers. Only the slot
+ * of the current tick is visited, plus one slot of level 1 every 64 ticks.
+ * If ticks were lost on a long task, they are served now.
+ */
+void timer_service(void)
+{
+    uint32_t tick = clock_tick_count();
+    while(wheelNow_ != tick)
+    {
+        wheelNow_++;
+
+        //Level 0 has turned, bring down the timers of the next 64 ticks
+        if((wheelNow_ & TIMER_WHEEL_MASK) == 0)
+        {
+            uint8_t slot = TIMER_WHEEL_SLOTS + ((wheelNow_ >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK);
+            uint8_t id = wheel_[slot];
+            wheel_[slot] = TIMER_NONE;
+            while(id != TIMER_NONE)
+            {
+                uint8_t next = timers_[id].next;
+                timers_[id].slot = TIMER_NONE;
+                timer_link(id);
+                id = next;
+            }
+        }
+
+        //Everything on this slot expires now
+        uint8_t slot = wheelNow_ & TIMER_WHEEL_MASK;
+        uint8_t id = wheel_[slot];
+        wheel_[slot] = TIMER_NONE;
+        while(id != TIMER_NONE)
+        {
+            struct Timer *timer = &timers_[id];
+            uint8_t next = timer->next;
+            timer->slot = TIMER_NONE;
+            timer->expired = 1;
+            if(timer->period != 0)
+            {
+                timer->expiry += timer->period;
+                timer_link(id);
+            }
+            else
+                timer->running = 0;
+            id = next;
+        }
+    }
+}
+
+/**
+ * It (re)starts a timer to expire in delay ms, and then every period ms if
+ * period is not 0. Times are rounded up to the 10ms tick.
+ */
+void timer_start(uint8_t id, uint32_t delay, uint32_t period)
+{
+    if(id >= TIMER_COUNT)
+        return;
+    struct Timer *timer = &timers_[id];
+    timer_unlink(id);
+    timer->expired = 0;
+    timer->period = (period + CLOCK_TICK_MS - 1) / CLOCK_TICK_MS;
+    uint32_t ticks = (delay + CLOCK_TICK_MS - 1) / CLOCK_TICK_MS;
+    if(ticks == 0)
+    {
+        //Already expired
+        timer->expired = 1;
+        if(timer->period == 0)
+        {
+            timer->running = 0;
+            return;
+        }
+        ticks = timer->period;
+    }
+    timer->expiry = wheelNow_ + ticks;
+    timer->running = 1;
+    timer_link(id);
+}
+
+/**
+ * It stops a timer, it will not expire
+ */
+void timer_cancel(uint8_t id)
+{
+    if(id >= TIMER_COUNT)
+        return;
+    timer_unlink(id);
+    timers_[id].running = 0;
+    timers_[id].expired = 0;
+}
+
+/**
+ * 1 if the timer has been started and has not expired yet (periodic timers
+ * run until cancelled)
+ */
+uint8_t timer_isRunning(uint8_t id)
+{
+    if(id >= TIMER_COUNT)
+        return 0;
+    return timers_[id].running;
+}
+
+/**
+ * 1 if the timer expired since the last call, it clears the flag
+ */
+uint8_t timer_expired(uint8_t id)
+{
+    if(id >= TIMER_COUNT)
+        return 0;
+    if(!timers_[id].expired)
+        return 0;
+    timers_[id].expired = 0;
+    return 1;
+}
+
+/**
+ * Time left until the timer expires [ms], 0 if it is not running
+ */
+uint32_t timer_remaining(uint8_t id)
+{
+    if(id >= TIMER_COUNT || !timers_[id].running)
+        return 0;
+    return (timers_[id].expiry - wheelNow_) * CLOCK_TICK_MS;
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the Supervisor on IRIS2 Flight Firmware
+ * Proyecto Daedalus - 2021
+ */
+
+#ifndef TIMERS_H_
+#define TIMERS_H_
+
+#include <stdint.h>
+#include <msp430.h>
+#include "clock.h"
+
+// Two level timer wheel on the 10ms scheduler tick. Level 0 has one slot per
+// tick (640ms), level 1 one slot per turn of level 0 (41s). Longer timers
+// wait on level 1 and are placed again every time they come around.
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       (1u << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_NONE              0xFF
+
+// Timers, one per deadline
+#define TIMER_SENSOR_SUNRISE    0
+#define TIMER_SENSOR_BARO       1
+#define TIMER_SENSOR_TEMP       2
+#define TIMER_SENSOR_INA        3
+#define TIMER_SENSOR_ACC        4
+#define TIMER_FLIGHT_TRIGGERS   5
+#define TIMER_CAM_STEP          6   // + camera, low level FSM
+#define TIMER_CAM_GLOBAL        10  // + camera, high level FSM
+#define TIMER_COUNT             14
+
+struct Timer
+{
+    uint32_t expiry;            //[tick]
+    uint32_t period;            //[ticks] 0 if one shot
+    uint8_t running;
+    uint8_t expired;            //Set on every expiry until timer_expired()
+    uint8_t slot;               //Slot of the wheel, TIMER_NONE if not linked
+    uint8_t next;
+    uint8_t prev;
+};
+
+void timer_init(void);
+void timer_service(void);
+void timer_start(uint8_t id, uint32_t delay, uint32_t period);
+void timer_cancel(uint8_t id);
+uint8_t timer_isRunning(uint8_t id);
+uint8_t timer_expired(uint8_t id);
+uint32_t timer_remaining(uint8_t id);
+
+#endif /* TIMERS_H_ */
@@ -13,47 +13,156 @@
 #define MUX_CAM3        (P2OUT |=  BIT4)
 #define MUX_CAM4        (P2OUT &= ~BIT4)
 #define MUX_STATUS_CAM3 (P2OUT &   BIT4)
+#define UART_DMA_CHUNK  32      //Bytes per DMA block, so room frees up steadily
+#define UART_TX_TIMEOUT 100     //ms without room on the TX buffer to give up,
+                                //a DMA block takes 33ms at 9600
 
 struct Port
 {
     uint8_t uart_name;
 
-    uint8_t bufferIn[UARTBUFFERLENGHT];
-    uint16_t bufferInStart;
-    uint16_t bufferInEnd;
-
-    uint8_t noDisableTXInterrupt;
-    uint8_t bufferOut[UARTBUFFERLENGHT];
-    uint16_t bufferOutStart;
-    uint16_t bufferOutEnd;
-
-    uint8_t somethingOnQueue;
-    uint8_t interruptWhenNoData;
+    struct RingBuffer rx;       //Produced by the RX interrupt
+    struct RingBuffer tx;       //Consumed by the TX interrupt, or the DMA
 
     uint32_t timeLastReceived;
-    uint16_t counterErrorSync;
-    uint16_t counterErrorCRC;
-    uint16_t counterErrorOverrun;
-    uint16_t counterErrorOverflow;
 
     uint8_t isOpen;
+    uint8_t baudrate;
+
+    volatile uint8_t txDrained;     //1 when the last byte left the shift register
+    volatile uint32_t txDrainedAt;  //millis_uptime() of that moment
+};
+
+//Error counters of a port, they survive resets
+struct PortErrors
+{
+    volatile uint16_t counterErrorSync;
+    volatile uint16_t counterErrorCRC;
+    volatile uint16_t counterErrorOverrun;
+    volatile uint16_t counterErrorOverflow;
+};
+
+//Buffers of a port
+struct PortBuffers
+{
+    uint8_t *rx;
+    uint16_t rxSize;
+    uint8_t *tx;
+    uint16_t txSize;
+};
+
+//Baud rate registers for one entry of the baud table
+struct BaudSetting
+{
+    uint32_t baudrate;      //Value in bits per second
+    uint16_t ucaxbrw;       //Clock prescaler
+    uint16_t ucaxmctlw;     //UCBRSx, UCBRFx and UCOS16
 };
 
 //Private variables
-volatile struct Port uart_device[UART_BUS_NUM] = {0};
-#pragma PERSISTENT (uart_device);
+struct Port uart_device[UART_BUS_NUM] = {0};
+#pragma PERSISTENT (uart_errors_);
+struct PortErrors uart_errors_[UART_BUS_NUM] = {0};
 static const uint16_t baseAddress[UART_BUS_NUM] = {DEBUG_BASE, CAM1_BASE, CAM2_BASE, CAM3_BASE, CAM3_BASE};
 
+//The buffers are on the RAM of the LEA, that is not used. It is SRAM, faster
+//than FRAM for the interrupts, and it does not take the RAM of the stack.
+#pragma DATA_SECTION (uartDebugRx_, ".leaRAM");
+#pragma DATA_SECTION (uartDebugTx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam1Rx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam1Tx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam2Rx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam2Tx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam3Rx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam3Tx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam4Rx_, ".leaRAM");
+#pragma DATA_SECTION (uartCam4Tx_, ".leaRAM");
+#if UART_DEBUG_RX_SIZE + UART_DEBUG_TX_SIZE + UART_CAM1_RX_SIZE + UART_CAM1_TX_SIZE \
+    + UART_CAM2_RX_SIZE + UART_CAM2_TX_SIZE + UART_CAM3_RX_SIZE + UART_CAM3_TX_SIZE \
+    + UART_CAM4_RX_SIZE + UART_CAM4_TX_SIZE > 3784
+#error "UART buffers do not fit in the LEA RAM"
+#endif
+static uint8_t uartDebugRx_[UART_DEBUG_RX_SIZE];
+static uint8_t uartDebugTx_[UART_DEBUG_TX_SIZE];
+static uint8_t uartCam1Rx_[UART_CAM1_RX_SIZE];
+static uint8_t uartCam1Tx_[UART_CAM1_TX_SIZE];
+static uint8_t uartCam2Rx_[UART_CAM2_RX_SIZE];
+static uint8_t uartCam2Tx_[UART_CAM2_TX_SIZE];
+static uint8_t uartCam3Rx_[UART_CAM3_RX_SIZE];
+static uint8_t uartCam3Tx_[UART_CAM3_TX_SIZE];
+static uint8_t uartCam4Rx_[UART_CAM4_RX_SIZE];
+static uint8_t uartCam4Tx_[UART_CAM4_TX_SIZE];
+
+static const struct PortBuffers portBuffers_[UART_BUS_NUM] =
+{
+    {uartDebugRx_, UART_DEBUG_RX_SIZE, uartDebugTx_, UART_DEBUG_TX_SIZE},
+    {uartCam1Rx_,  UART_CAM1_RX_SIZE,  uartCam1Tx_,  UART_CAM1_TX_SIZE},
+    {uartCam2Rx_,  UART_CAM2_RX_SIZE,  uartCam2Tx_,  UART_CAM2_TX_SIZE},
+    {uartCam3Rx_,  UART_CAM3_RX_SIZE,  uartCam3Tx_,  UART_CAM3_TX_SIZE},
+    {uartCam4Rx_,  UART_CAM4_RX_SIZE,  uartCam4Tx_,  UART_CAM4_TX_SIZE},
+};
+
+//UART_DEBUG TX is moved by DMA channel 0, triggered by UCA0TXIFG. This is the
+//number of bytes of the TX buffer that the DMA is sending right now (0 = idle)
+static volatile uint16_t debugDmaLength_ = 0;
+
+//Load measurements
+static volatile struct UartStatistics uart_statistics_[UART_BUS_NUM] = {0};
+
+//Arbitration of the mux shared by UART_CAM3 and UART_CAM4: the owner keeps the
+//mux until its hold time is over (waiting for the camera to answer) and its
+//last byte has been sent. Writes of the other camera wait on its TX buffer.
+static uint8_t muxOwner_ = UART_CAM3;
+static uint32_t muxHoldUntil_ = 0;
+
+//Baud rates for every clock profile of SMCLK, see table at page 782 in users
+//guide. Indexed by CLOCK_PROFILE_xxx and BR_9600, BR_38400... A prescaler of
+//0 means that the baudrate can not be made with that clock.
+static const struct BaudSetting baudTable_[CLOCK_PROFILE_COUNT][BR_COUNT] =
+{
+    {   //1 MHz
+        {  9600,  6, 0x2000 | UCOS16 | UCBRF_8},
+        { 38400,  1, 0x0000 | UCOS16 | UCBRF_10},
+        { 57600, 17, 0x4A00},
+        {115200,  8, 0xD600},
+        {230400,  0, 0},
+        {460800,  0, 0},
+        {921600,  0, 0},
+    },
+    {   //8 MHz
+        {  9600, 52, 0x4900 | UCOS16 | UCBRF_1},
+        { 38400, 13, 0x8400 | UCOS16 | UCBRF_0},
+        { 57600,  8, 0xF700 | UCOS16 | UCBRF_10},
+        {115200,  4, 0x5500 | UCOS16 | UCBRF_5},
+        {230400,  2, 0xBB00 | UCOS16 | UCBRF_2},
+        {460800,  1, 0x4A00 | UCOS16 | UCBRF_1},
+        {921600,  8, 0xD600},                   //No oversampling, N < 16
+    },
+    {   //16 MHz
+        {  9600,104, 0xD600 | UCOS16 | UCBRF_2},
+        { 38400, 26, 0xB600 | UCOS16 | UCBRF_0},
+        { 57600, 17, 0xDD00 | UCOS16 | UCBRF_5},
+        {115200,  8, 0xF700 | UCOS16 | UCBRF_10},
+        {230400,  4, 0x5500 | UCOS16 | UCBRF_5},
+        {460800,  2, 0xBB00 | UCOS16 | UCBRF_2},
+        {921600,  1, 0x4A00 | UCOS16 | UCBRF_1},
+    },
+};
+
 //Private functions:
-int16_t bufferSize(uint8_t isOut, uint8_t uart_name);
-void uart_safe_tx_byte(uint8_t uart_name);
-int8_t uart_write_internal(uint8_t uart_name, uint8_t *buffer, uint16_t lenght);
+void uart_dma_start(void);
+void uart_dma_stop(void);
+void uart_tx_complete(uint8_t uart_name);
+void uart_mirror(const uint8_t *data, uint8_t length);
+int8_t uart_write_internal(uint8_t uart_name, const uint8_t *buffer,
+                           uint16_t lenght, uint8_t startTx);
 
 /******************************************************************************
  * It configures the UART port with the selected baudrate
  *      Select UART device name: UART_DEBUG, UART_CAM1, UART_CAM2, UART_CAM3,
  *                               UART_CAM4
- *      Select BAUDRATE: BR_9600, BR_38400, BR_115200
+ *      Select BAUDRATE: BR_9600, BR_38400, BR_57600, BR_115200, BR_230400,
+ *                       BR_460800, BR_921600
  * Watch out!, CAM4 is multiplexed with CAM3!!!
  */
 int8_t uart_init(uint8_t uart_name, uint8_t baudrate)
@@ -64,6 +173,15 @@ int8_t uart_init(uint8_t uart_name, uint8_t baudrate)
         P2SEL0 &= ~(BIT0 | BIT1);
         P2SEL1 |= (BIT0 | BIT1);
         uart_device[uart_name].uart_name = UART_DEBUG;
+
+        //DMA channel 0 is triggered when UCA0TXBUF is empty
+        uart_dma_stop();
+        DMACTL0 = (DMACTL0 & 0xFF00) | DMA0TSEL__UCA0TXIFG;
+        //Do not let the DMA interrupt a read-modify-write of the CPU
+        DMACTL4 = DMARMWDIS;
+
+        //Bytes of the camera in uartdebug mode, see the RX interrupts
+        deferred_setHandler(DEFERRED_UART_MIRROR, uart_mirror);
     }
     else if(uart_name == UART_CAM1)
     {
@@ -90,9 +208,8 @@ int8_t uart_init(uint8_t uart_name, uint8_t baudrate)
         P2DIR |= BIT3;
         P2DIR |= BIT4;
 
-        //Switch on Mux and select camera
+        //Switch on Mux, the camera is selected by the arbiter
         MUX_ON;
-        MUX_CAM3;
     }
     else if(uart_name == UART_CAM4)
     {
@@ -106,47 +223,45 @@ int8_t uart_init(uint8_t uart_name, uint8_t baudrate)
         P2DIR |= BIT3;
         P2DIR |= BIT4;
 
-        //Switch on Mux and select camera
+        //Switch on Mux, the camera is selected by the arbiter
         MUX_ON;
-        MUX_CAM4;
     }
 
     //Set the uart status:
     uart_device[uart_name].isOpen = 1;
-    uart_device[uart_name].bufferInStart = 0;
-    uart_device[uart_name].bufferInEnd = 0;
-    uart_device[uart_name].bufferOutStart = 0;
-    uart_device[uart_name].bufferOutEnd = 0;
-    uart_device[uart_name].counterErrorSync = 0;
-    uart_device[uart_name].counterErrorCRC = 0;
-    uart_device[uart_name].counterErrorOverrun = 0;
-    uart_device[uart_name].counterErrorOverflow = 0;
+    ring_init(&uart_device[uart_name].rx, portBuffers_[uart_name].rx, portBuffers_[uart_name].rxSize);
+    ring_init(&uart_device[uart_name].tx, portBuffers_[uart_name].tx, portBuffers_[uart_name].txSize);
+    uart_device[uart_name].txDrained = 1;
+
+    //Take the mux if the other camera is not using it
+    uart_mux_request(uart_name, 0);
+
+    return uart_set_baudrate(uart_name, baudrate);
+}
+
+/**
+ * It (re)configures the baudrate of an already configured port. The eUSCI is
+ * put in reset meanwhile, so whatever is being shifted out is lost, flush it
+ * before calling this. Buffers are not touched.
+ * Returns -1 if the baudrate is not on the table, -2 if it can not be made
+ * with the current clock profile.
+ */
+int8_t uart_set_baudrate(uint8_t uart_name, uint8_t baudrate)
+{
+    if(baudrate >= BR_COUNT)
+        return -1;
+    if(!uart_baudrate_supported(clock_getProfile(), baudrate))
+        return -2;
+
+    uart_device[uart_name].baudrate = baudrate;
+    const struct BaudSetting *setting = &baudTable_[clock_getProfile()][baudrate];
 
     // Put eUSCI in reset
     HWREG16(baseAddress[uart_name] + OFS_UCAxCTLW0) |= UCSWRST;
     HWREG16(baseAddress[uart_name] + OFS_UCAxCTLW0) |= UCSSEL__SMCLK;
 
-    //Baud rates for 8 MHz clock SMCLK, see table at page 782 in users guide
-    if(baudrate == BR_9600)
-    {
-        HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) = 52;
-        HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) = 0x4900 | UCOS16 | UCBRF_1;
-    }
-    else if(baudrate == BR_38400)
-    {
-        HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) = 13;
-        HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) = 0x8400 | UCOS16 | UCBRF_0;
-    }
-    else if(baudrate == BR_57600)
-    {
-        HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) = 8;
-        HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) = 0xF700 | UCOS16 | UCBRF_10;
-    }
-    else if(baudrate == BR_115200)
-    {
-        HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) = 4;
-        HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) = 0x5500 | UCOS16 | UCBRF_5;
-    }
+    HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) = setting->ucaxbrw;
+    HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) = setting->ucaxmctlw;
 
     //Initialize eUSCI
     HWREG16(baseAddress[uart_name] + OFS_UCAxCTLW0) &= ~UCSWRST;
@@ -156,6 +271,75 @@ int8_t uart_init(uint8_t uart_name, uint8_t baudrate)
     return 0;
 }
 
+/**
+ * Returns the BR_xxx baudrate the port was configured with
+ */
+uint8_t uart_get_baudrate(uint8_t uart_name)
+{
+    return uart_device[uart_name].baudrate;
+}
+
+/**
+ * Returns the baudrate in bits per second of a BR_xxx value, 0 if unknown
+ */
+uint32_t uart_baudrate_value(uint8_t baudrate)
+{
+    if(baudrate >= BR_COUNT)
+        return 0;
+    return baudTable_[CLOCK_PROFILE_DEFAULT][baudrate].baudrate;
+}
+
+/**
+ * 1 if the baudrate can be made with the SMCLK of the clock profile
+ */
+uint8_t uart_baudrate_supported(uint8_t profile, uint8_t baudrate)
+{
+    if(profile >= CLOCK_PROFILE_COUNT || baudrate >= BR_COUNT)
+        return 0;
+    return baudTable_[profile][baudrate].ucaxbrw != 0;
+}
+
+/**
+ * After a change of the clock profile, it sets again the baudrate of every
+ * open port. Flush them before changing the clock.
+ * Returns the number of ports that could not be set.
+ */
+uint8_t uart_retime(void)
+{
+    uint8_t errors = 0;
+    uint8_t i;
+    for(i = 0; i < UART_BUS_NUM; i++)
+    {
+        if(!uart_device[i].isOpen)
+            continue;
+        if(uart_set_baudrate(i, uart_device[i].baudrate) != 0)
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * 1 if the registers of the port hold the baudrate of the current clock
+ * profile, for the self-test after a change of clock
+ */
+uint8_t uart_check_baudrate(uint8_t uart_name)
+{
+    const struct BaudSetting *setting =
+            &baudTable_[clock_getProfile()][uart_device[uart_name].baudrate];
+    return HWREG16(baseAddress[uart_name] + OFS_UCAxBR0) == setting->ucaxbrw
+        && HWREG16(baseAddress[uart_name] + OFS_UCAxMCTLW) == setting->ucaxmctlw;
+}
+
+/**
+ * 1 if the port is open
+ */
+uint8_t uart_isOpen(uint8_t uart_name)
+{
+    if(uart_name >= UART_BUS_NUM)
+        return 0;
+    return uart_device[uart_name].isOpen;
+}
+
 /**
  * It puts the GPIOs of the UARTs in high impedance, so the camera is switched off and
  * not drawing current from the pins.
@@ -167,6 +351,7 @@ void uart_close(uint8_t uart_name)
 
     if(uart_name == UART_DEBUG)
     {
+        uart_dma_stop();
         //USCI_A0_
         P2SEL0 &= ~(BIT0 | BIT1);
         P2SEL1 &= ~(BIT0 | BIT1);
@@ -196,6 +381,8 @@ void uart_close(uint8_t uart_name)
         {
             //Only move the switch to CAM4:
             MUX_CAM4;
+            muxOwner_ = UART_CAM4;
+            muxHoldUntil_ = 0;
         }
         else
         {
@@ -217,6 +404,8 @@ void uart_close(uint8_t uart_name)
         {
             //Only move the switch to CAM3:
             MUX_CAM3;
+            muxOwner_ = UART_CAM3;
+            muxHoldUntil_ = 0;
         }
         else
         {
@@ -237,45 +426,20 @@ void uart_close(uint8_t uart_name)
 }
 
 /**
- * It clears all the pointers and counters of a specific port
+ * It empties both buffers of a specific port
  */
 void uart_clear_buffer(uint8_t uart_name)
 {
-    uart_device[uart_name].bufferInStart = 0;
-    uart_device[uart_name].bufferInEnd = 0;
-    uart_device[uart_name].bufferOutStart = 0;
-    uart_device[uart_name].bufferOutEnd = 0;
-    uart_device[uart_name].counterErrorSync = 0;
-    uart_device[uart_name].counterErrorCRC = 0;
-    uart_device[uart_name].counterErrorOverrun = 0;
-    uart_device[uart_name].counterErrorOverflow = 0;
-}
-
-
-/*
- * It counts the size of the buffer
- * This function must not be called outside of this file (it is not available
- * in the uart.h file.
- */
-int16_t bufferSize(uint8_t isOut, uint8_t uart_name)
-{
-    if(isOut == 0)
-    {
-        if(uart_device[uart_name].bufferInEnd > uart_device[uart_name].bufferInStart)
-            return ((uart_device[uart_name].bufferInEnd) - (uart_device[uart_name].bufferInStart));
-        else if(uart_device[uart_name].bufferInEnd < uart_device[uart_name].bufferInStart)
-            return (UARTBUFFERLENGHT - uart_device[uart_name].bufferInStart + uart_device[uart_name].bufferInEnd);
-        else
-            uart_device[uart_name].somethingOnQueue = 0;
-    }
-    else
-    {
-        if(uart_device[uart_name].bufferOutEnd > uart_device[uart_name].bufferOutStart)
-            return (uart_device[uart_name].bufferOutEnd - uart_device[uart_name].bufferOutStart);
-        else if(uart_device[uart_name].bufferOutEnd < uart_device[uart_name].bufferOutStart)
-            return (UARTBUFFERLENGHT - uart_device[uart_name].bufferOutStart + uart_device[uart_name].bufferOutEnd);
-    }
-    return 0;
+    if(uart_name == UART_DEBUG)
+        uart_dma_stop();
+    //Both sides of the rings are reset, so no interrupt can be using them
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    ring_init(&uart_device[uart_name].rx, portBuffers_[uart_name].rx, portBuffers_[uart_name].rxSize);
+    ring_init(&uart_device[uart_name].tx, portBuffers_[uart_name].tx, portBuffers_[uart_name].txSize);
+    __set_interrupt_state(interruptState);
+    //Nothing left to send
+    uart_device[uart_name].txDrained = 1;
 }
 
 
@@ -284,7 +448,7 @@ int16_t bufferSize(uint8_t isOut, uint8_t uart_name)
  */
 int16_t uart_available(uint8_t uart_name)
 {
-    return bufferSize(0, uart_name);
+    return ring_count(&uart_device[uart_name].rx);
 }
 
 /*
@@ -292,146 +456,239 @@ int16_t uart_available(uint8_t uart_name)
  */
 int16_t uart_tx_onWait(uint8_t uart_name)
 {
-    return bufferSize(1, uart_name);
+    return ring_count(&uart_device[uart_name].tx);
 }
 
-uint8_t pointerTimes = 0;
-uint32_t timesDebug[30];
+/*
+ * It copies the load counters of the port
+ */
+void uart_get_statistics(uint8_t uart_name, struct UartStatistics *statistics)
+{
+    statistics->rxInterrupts = uart_statistics_[uart_name].rxInterrupts;
+    statistics->txInterrupts = uart_statistics_[uart_name].txInterrupts;
+    statistics->dmaTransfers = uart_statistics_[uart_name].dmaTransfers;
+    statistics->txBufferFull = uart_statistics_[uart_name].txBufferFull;
+    statistics->overrunErrors = uart_errors_[uart_name].counterErrorOverrun;
+    statistics->overflowErrors = uart_errors_[uart_name].counterErrorOverflow;
+}
 
 /*
- * It blocks execution until uart is empty, or after 20ms
+ * If the DMA is idle, it starts sending the next contiguous block of the
+ * UART_DEBUG TX buffer. Safe to call from the main loop and from the DMA
+ * interrupt.
  */
-void uart_flush(uint8_t uart_name)
+void uart_dma_start(void)
 {
-    uint32_t timeStart = (uint32_t)millis_uptime();
-    while(uart_tx_onWait(uart_name))
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+
+    uint8_t *span;
+    //Only until the end of the buffer, the rest on next round
+    uint16_t length = ring_span(&uart_device[UART_DEBUG].tx, &span);
+    //And in small blocks, the buffer is only released when a block ends
+    if(length > UART_DMA_CHUNK)
+        length = UART_DMA_CHUNK;
+    if(debugDmaLength_ == 0 && length != 0)
     {
-        uint32_t timeNow = (uint32_t)millis_uptime();
-        if(timeStart + 20 < timeNow)
-        {
-            timesDebug[pointerTimes] = timeNow - timeStart;
-            pointerTimes++;
-            if(pointerTimes >= 30)
-                pointerTimes = 0;
-            return;//break execution just in case
-        }
+        debugDmaLength_ = length;
+
+        __data20_write_long((uintptr_t) &DMA0SA, (uintptr_t) span);
+        __data20_write_long((uintptr_t) &DMA0DA, (uintptr_t) &UCA0TXBUF);
+        DMA0SZ = debugDmaLength_;
+        //Single transfer, byte to byte, incrementing only the source
+        DMA0CTL = DMADT_0 | DMASRCINCR_3 | DMADSTINCR_0 | DMASBDB | DMAIE | DMAEN;
+
+        //The trigger is the rising edge of UCTXIFG, that is already set when
+        //idle, so generate the edge
+        UCA0IFG &= ~UCTXIFG;
+        UCA0IFG |= UCTXIFG;
     }
 
-    uint32_t timeNow = (uint32_t)millis_uptime();
-    timesDebug[pointerTimes] = timeNow - timeStart;
-    pointerTimes++;
-    if(pointerTimes >= 30)
-        pointerTimes = 0;
-
-    sleep_ms(5);
+    __set_interrupt_state(interruptState);
 }
 
 /*
- * Returns the last byte in buffer
+ * It aborts the DMA transfer of UART_DEBUG
  */
-uint8_t uart_read(uint8_t uart_name)
+void uart_dma_stop(void)
 {
-    //Buffer was empty. Send last byte as safe
-    if(uart_device[uart_name].bufferInEnd == uart_device[uart_name].bufferInStart)
-        return (uart_device[uart_name].bufferIn[(uart_device[uart_name].bufferInStart)]);
-
-    uint8_t byteToSend;
-    byteToSend = uart_device[uart_name].bufferIn[(uart_device[uart_name].bufferInStart)];
-
-    //Increment buffer pointer
-    uart_device[uart_name].bufferInStart++;
-
-    //Sanity check
-    if(uart_device[uart_name].bufferInStart >= UARTBUFFERLENGHT)
-        uart_device[uart_name].bufferInStart = 0;
+    DMA0CTL &= ~(DMAEN | DMAIE | DMAIFG);
+    debugDmaLength_ = 0;
+}
 
-    return byteToSend;
+/**
+ * Returns 1 when everything written to the port has been physically sent,
+ * the last byte included. Use it instead of uart_flush() to sequence
+ * without blocking.
+ */
+uint8_t uart_tx_isDrained(uint8_t uart_name)
+{
+    return uart_device[uart_name].txDrained;
 }
 
+/**
+ * millis_uptime() of the moment the port got drained. Only meaningful while
+ * uart_tx_isDrained() returns 1
+ */
+uint32_t uart_tx_drainedAt(uint8_t uart_name)
+{
+    return uart_device[uart_name].txDrainedAt;
+}
 
-void uart_safe_tx_byte(uint8_t uart_name)
+/*
+ * Called from the UCTXCPTIFG interrupt, when a byte has completely left the
+ * shift register and UCAxTXBUF is empty. The port is drained only if there is
+ * nothing else on the TX buffer (or on its way through the DMA).
+ * This function must not be called outside of this file.
+ */
+void uart_tx_complete(uint8_t uart_name)
 {
-    if(uart_device[uart_name].interruptWhenNoData == 0)
+    if(uart_device[uart_name].txDrained)
+        return;
+    if(ring_count(&uart_device[uart_name].tx) != 0)
         return;
+    if(uart_name == UART_DEBUG && debugDmaLength_ != 0)
+        return;
+    if((HWREG16(baseAddress[uart_name] + OFS_UCAxIFG) & UCTXIFG) == 0)
+        return;     //Next byte already loaded, wait for its completion
+    uart_device[uart_name].txDrainedAt = millis_uptime();
+    uart_device[uart_name].txDrained = 1;
+}
 
-    uart_device[uart_name].interruptWhenNoData = 0;
-    //Watch out, is not that the buffer is now empty, isn't it?
-    if(uart_device[uart_name].bufferOutEnd == uart_device[uart_name].bufferOutStart)
-        return ;
+/**
+ * It asks for the mux shared by UART_CAM3 and UART_CAM4, and keeps it for at
+ * least holdTime ms (the time the camera needs to answer). The mux only moves
+ * when the other camera has sent everything and its hold time is over.
+ * Returns 1 if the port owns the mux, 0 if it has to wait. Other ports are
+ * not multiplexed and always return 1.
+ */
+int8_t uart_mux_request(uint8_t uart_name, uint16_t holdTime)
+{
+    if(uart_name != UART_CAM3 && uart_name != UART_CAM4)
+        return 1;
 
-    uint8_t byte2write = uart_device[uart_name].bufferOut[(uart_device[uart_name].bufferOutStart)];
-    uart_device[uart_name].bufferOutStart++;
-    if(uart_device[uart_name].bufferOutStart >= UARTBUFFERLENGHT)
-        uart_device[uart_name].bufferOutStart = 0;
+    uint32_t uptime = millis_uptime();
+    if(muxOwner_ != uart_name)
+    {
+        //Is the other camera still talking or waiting for its answer?
+        if(uart_device[muxOwner_].isOpen
+                && (MS_AFTER(muxHoldUntil_, uptime) || !uart_device[muxOwner_].txDrained))
+            return 0;
 
-    //We need to refill the buffer
+        muxOwner_ = uart_name;
+        if(uart_name == UART_CAM3)
+            MUX_CAM3;
+        else
+            MUX_CAM4;
+        muxHoldUntil_ = uptime;
 
-    while((HWREG16(baseAddress[uart_name]+ OFS_UCAxSTATW)) & UCBUSY);
-    HWREG16(baseAddress[uart_name]+ OFS_UCAxTXBUF) = byte2write;
-    //Reenable interrupt
-    HWREG16(baseAddress[uart_name]+ OFS_UCAxIE) |= UCTXIE;
+        //Send what was waiting for the mux, TXIFG is set as the line is idle
+        if(ring_count(&uart_device[uart_name].tx) != 0)
+            HWREG16(baseAddress[uart_name] + OFS_UCAxIE) |= UCTXIE;
+    }
 
+    if(MS_AFTER(uptime + holdTime, muxHoldUntil_))
+        muxHoldUntil_ = uptime + holdTime;
+    return 1;
 }
 
-/*
- * This function sends a buffer to the selected port.
- * This function must not be called outside of this file (it is not available
- * in the g_uart.h file.
+/**
+ * It gives up the rest of the hold time of the mux, if owned
  */
-int8_t uart_write_internal(uint8_t uart_name, uint8_t *buffer, uint16_t lenght)
+void uart_mux_release(uint8_t uart_name)
 {
-    //Copy next byte to buffer
-    uint32_t position = 0;
+    if(muxOwner_ == uart_name)
+        muxHoldUntil_ = millis_uptime();
+}
 
-    uint8_t isBusy = 0;
+/**
+ * To be called periodically: it gives the mux to the camera that is not
+ * owning it if it has bytes waiting to be sent.
+ */
+void uart_mux_service(void)
+{
+    uint8_t other = UART_CAM3;
+    if(muxOwner_ == UART_CAM3)
+        other = UART_CAM4;
+    if(uart_device[other].isOpen && ring_count(&uart_device[other].tx) != 0)
+        uart_mux_request(other, UART_MUX_HOLD);
+}
 
-    if((bufferSize(1, uart_name) == 0) && (isBusy == 0))
+/*
+ * It blocks execution until the last byte has been sent, or after 20ms
+ */
+void uart_flush(uint8_t uart_name)
+{
+    profiler_begin(PROFILER_UART_FLUSH);
+    uint32_t timeStart = (uint32_t)millis_uptime();
+    while(!uart_device[uart_name].txDrained)
     {
-        while((HWREG16(baseAddress[uart_name]+ OFS_UCAxSTATW)) & UCBUSY);
-        HWREG16(baseAddress[uart_name]+ OFS_UCAxTXBUF) = *buffer;
-
-        buffer++;
-        position++;
+        uint32_t timeNow = (uint32_t)millis_uptime();
+        if(MS_ELAPSED(timeStart, timeNow) > 20)
+            break;  //break execution just in case
     }
+    profiler_end(PROFILER_UART_FLUSH);
+}
 
-    while (position != lenght)
+/*
+ * Returns the next byte received, 0 if there is none
+ */
+uint8_t uart_read(uint8_t uart_name)
+{
+    uint8_t byte = 0;
+    ring_pop(&uart_device[uart_name].rx, &byte);
+    return byte;
+}
+
+/*
+ * This function sends a buffer to the selected port.
+ * This function must not be called outside of this file (it is not available
+ * in the g_uart.h file.
+ */
+int8_t uart_write_internal(uint8_t uart_name, const uint8_t *buffer,
+                           uint16_t lenght, uint8_t startTx)
+{
+    struct RingBuffer *tx = &uart_device[uart_name].tx;
+    uint32_t lastProgress = millis_uptime();
+    uint8_t waiting = 0;
+    while(1)
     {
-        uint16_t wait = 1000;
-        //Block code to avoid buffer overflow
-        //TODO, we need to add a failsafe to overwrite this.
-        while(bufferSize(1, uart_name) == (UARTBUFFERLENGHT - 1))
+        uint16_t written = ring_write(tx, buffer, lenght);
+        buffer += written;
+        lenght -= written;
+
+        //The DMA or the TX interrupt take it from here. UCTXIFG is set while
+        //UCAxTXBUF is empty, so enabling UCTXIE is enough to start sending
+        if(uart_name == UART_DEBUG)
+            uart_dma_start();
+        else if(startTx)
+            HWREG16(baseAddress[uart_name] + OFS_UCAxIE) |= UCTXIE;
+
+        if(lenght == 0)
+            return 0;
+
+        //Buffer full, wait for room. A port waiting for the mux is not
+        //moving, keep asking for it and do not give up meanwhile
+        uint32_t uptime = millis_uptime();
+        if(!startTx)
         {
-            //It can happen that with multiple interrupts,
-            //TX is not triggered so we have to force the TX...
-            if(uart_device[uart_name].interruptWhenNoData == 1)
-                uart_safe_tx_byte(uart_name);
-
-            wait--;
-            if(wait == 0)
-                break;
+            startTx = uart_mux_request(uart_name, UART_MUX_HOLD);
+            if(!startTx)
+                lastProgress = uptime;
         }
-
-        //Ok there is space in the buffer, lets go:
-        uart_device[uart_name].bufferOut[(uart_device[uart_name].bufferOutEnd)] = *buffer;
-        position++;
-
-        uart_device[uart_name].bufferOutEnd++;
-        if(uart_device[uart_name].bufferOutEnd >= UARTBUFFERLENGHT)
-            uart_device[uart_name].bufferOutEnd = 0;
-
-        if(position >= lenght)
-            break;
-
-        //Do it as the last thing to avoid buffer overflow
-        buffer++;
+        if(written != 0)
+        {
+            lastProgress = uptime;
+            waiting = 0;
+        }
+        if(!waiting)
+        {
+            uart_statistics_[uart_name].txBufferFull++;
+            waiting = 1;
+        }
+        if(MS_ELAPSED(lastProgress, uptime) > UART_TX_TIMEOUT)
+            return -1;  //Not moving, the rest is lost
     }
-
-    //It can happen that the interrupt started while buffer was still empty
-    //so now that has been filled, lets trigger it again:
-    if(uart_device[uart_name].interruptWhenNoData == 1)
-        uart_safe_tx_byte(uart_name);
-
-    return 0;
 }
 
 
@@ -444,23 +701,36 @@ int8_t uart_write(uint8_t uart_name, uint8_t *buffer, uint16_t length)
     if(uart_device[uart_name].isOpen == 0)
         return -1;  //No! very much error
 
-    uart_device[uart_name].noDisableTXInterrupt = 1;
-
-    //Should we multiplex?
-    if(uart_name == UART_CAM3)
-        MUX_CAM3;
-    else if(uart_name == UART_CAM4)
-        MUX_CAM4;
+    //Should we multiplex? If the other camera owns the mux, bytes wait on
+    //the buffer until the arbiter gives it to us
+    uint8_t startTx = uart_mux_request(uart_name, UART_MUX_HOLD);
 
-    //Enable TX interrupt
-    HWREG16(baseAddress[uart_name]+ OFS_UCAxIE) |= UCTXIE;
+    //Not drained from now on, before the first byte can leave. The TX
+    //complete interrupt is kept off while the bytes are queued, so the end of
+    //a previous write does not see an empty buffer and mark it drained
+    uint16_t interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    uart_device[uart_name].txDrained = 0;
+    HWREG16(baseAddress[uart_name] + OFS_UCAxIE) &= ~UCTXCPTIE;
+    HWREG16(baseAddress[uart_name] + OFS_UCAxIFG) &= ~UCTXCPTIFG;
+    __set_interrupt_state(interruptState);
 
-    uart_write_internal(uart_name, buffer, length);
+    int8_t error = uart_write_internal(uart_name, buffer, length, startTx);
 
+    //Ask for a TX complete interrupt once the last byte leaves. If it has
+    //already left, its flag is pending and the interrupt comes right away
+    HWREG16(baseAddress[uart_name] + OFS_UCAxIE) |= UCTXCPTIE;
 
-    uart_device[uart_name].noDisableTXInterrupt = 0;
+    return error;
+}
 
-    return 0;
+/**
+ * Bytes received from the camera selected with uartdebug, queued by its RX
+ * interrupt. They go through the TX buffer so they do not step on the DMA.
+ */
+void uart_mirror(const uint8_t *data, uint8_t length)
+{
+    uart_write(UART_DEBUG, (uint8_t *)data, length);
 }
 
 /**
@@ -492,29 +762,16 @@ __interrupt void USCI_A0_ISR(void)
         case USCI_UART_UCRXIFG:
         {
             UCA0IFG &=~ UCRXIFG;            // Clear interrupt
+            uart_statistics_[UART_DEBUG].rxInterrupts++;
             //UCA0IE &=~UCRXIE;   //Disable RX interrupt
 
             //Check RX Overrun flag
             if((UCA0STATW & UCOE) != 0)
-                uart_device[UART_DEBUG].counterErrorOverrun++;
-
-            uart_device[UART_DEBUG].bufferIn[(uart_device[UART_DEBUG].bufferInEnd)] = UCA0RXBUF;
-            uart_device[UART_DEBUG].bufferInEnd++;
-            if((uart_device[UART_DEBUG].bufferInEnd) >= UARTBUFFERLENGHT)
-                uart_device[UART_DEBUG].bufferInEnd = 0;
-
-            //Buffer overflow? delete last character
-            if((uart_device[UART_DEBUG].bufferInEnd) == (uart_device[UART_DEBUG].bufferInStart))
-            {
-                uart_device[UART_DEBUG].counterErrorOverflow++;
-                uart_device[UART_DEBUG].bufferInStart++;
-            }
-
-            if((uart_device[UART_DEBUG].bufferInStart) >= UARTBUFFERLENGHT)
-              uart_device[UART_DEBUG].bufferInStart = 0;
-
+                uart_errors_[UART_DEBUG].counterErrorOverrun++;
 
-            uart_device[UART_DEBUG].somethingOnQueue = 1;
+            //Full: the new byte is lost, the reader owns the old ones
+            if(ring_push(&uart_device[UART_DEBUG].rx, UCA0RXBUF) != 0)
+                uart_errors_[UART_DEBUG].counterErrorOverflow++;
 
             //UCA0IE |= UCRXIE; //Enable RX interrupt
 
@@ -522,34 +779,26 @@ __interrupt void USCI_A0_ISR(void)
 
         case USCI_UART_UCTXIFG:
         {
-
-            if((uart_device[UART_DEBUG].bufferOutEnd) == (uart_device[UART_DEBUG].bufferOutStart))
+            uint8_t byte;
+            if(ring_pop(&uart_device[UART_DEBUG].tx, &byte) != 0)
             {
-                //Finish sending, disable TX interrupt and bye bye
-                if((uart_device[UART_DEBUG].noDisableTXInterrupt) == 0)
-                    UCA0IE &= ~UCTXIE;
-                else
-                {
-                    UCA0IE &= ~UCTXIE;
-                    uart_device[UART_DEBUG].interruptWhenNoData = 1;
-                }
+                //Finish sending, uart_write() enables it again
+                UCA0IE &= ~UCTXIE;
                 break;
             }
 
             //We have to send the next byte in the buffer
-            UCA0TXBUF = uart_device[UART_DEBUG].bufferOut[(uart_device[UART_DEBUG].bufferOutStart)];
-
-            uart_device[UART_DEBUG].bufferOutStart++;
-            if(uart_device[UART_DEBUG].bufferOutStart >= UARTBUFFERLENGHT)
-                uart_device[UART_DEBUG].bufferOutStart = 0;
-
-            uart_device[UART_DEBUG].interruptWhenNoData = 0;
-
-
+            uart_statistics_[UART_DEBUG].txInterrupts++;
+            UCA0TXBUF = byte;
         }break;
 
         case USCI_UART_UCSTTIFG: break;
-        case USCI_UART_UCTXCPTIFG: break;
+        case USCI_UART_UCTXCPTIFG:
+        {
+            uart_tx_complete(UART_DEBUG);
+            if(uart_device[UART_DEBUG].txDrained)
+                UCA0IE &= ~UCTXCPTIE;
+        }break;
     }
 }
 
@@ -566,61 +815,43 @@ __interrupt void USCI_A1_ISR(void)
         case USCI_UART_UCRXIFG:
         {
             UCA1IFG &=~ UCRXIFG;            // Clear interrupt
+            uart_statistics_[UART_CAM1].rxInterrupts++;
 
             //Check RX Overrun flag
             if((UCA1STATW & UCOE) != 0)
-                uart_device[UART_CAM1].counterErrorOverrun++;
+                uart_errors_[UART_CAM1].counterErrorOverrun++;
 
             uint8_t buffer = UCA1RXBUF;
-            uart_device[UART_CAM1].bufferIn[(uart_device[UART_CAM1].bufferInEnd)] = buffer;
-            uart_device[UART_CAM1].bufferInEnd++;
-            if((uart_device[UART_CAM1].bufferInEnd) >= UARTBUFFERLENGHT)
-                uart_device[UART_CAM1].bufferInEnd = 0;
-
-            //Buffer overflow? delete last character
-            if((uart_device[UART_CAM1].bufferInEnd) == (uart_device[UART_CAM1].bufferInStart))
-            {
-                uart_device[UART_CAM1].counterErrorOverflow++;
-                uart_device[UART_CAM1].bufferInStart++;
-            }
-
-
-            if((uart_device[UART_CAM1].bufferInStart) >= UARTBUFFERLENGHT)
-              uart_device[UART_CAM1].bufferInStart = 0;
-
-
-            uart_device[UART_CAM1].somethingOnQueue = 1;
+            //Full: the new byte is lost, the reader owns the old ones
+            if(ring_push(&uart_device[UART_CAM1].rx, buffer) != 0)
+                uart_errors_[UART_CAM1].counterErrorOverflow++;
 
+            //Mirror on the console, sent by the scheduler with the rest
             if(confRegister_.debugUART == 1)
-                UCA0TXBUF = buffer;
+                deferred_push(DEFERRED_UART_MIRROR, buffer);
         }break;
 
         case USCI_UART_UCTXIFG:
         {
-            if((uart_device[UART_CAM1].bufferOutEnd) == (uart_device[UART_CAM1].bufferOutStart))
+            uint8_t byte;
+            if(ring_pop(&uart_device[UART_CAM1].tx, &byte) != 0)
             {
-                //Finish sending, disable TX interrupt and bye bye
-                if((uart_device[UART_CAM1].noDisableTXInterrupt) == 0)
-                    UCA1IE &= ~UCTXIE;
-                else
-                {
-                    UCA1IE &= ~UCTXIE;
-                    uart_device[UART_CAM1].interruptWhenNoData = 1;
-                }
+                //Finish sending, uart_write() enables it again
+                UCA1IE &= ~UCTXIE;
                 break;
             }
 
             //We have to send the next byte in the buffer
-            UCA1TXBUF = uart_device[UART_CAM1].bufferOut[(uart_device[UART_CAM1].bufferOutStart)];
-
-            uart_device[UART_CAM1].bufferOutStart++;
-            if(uart_device[UART_CAM1].bufferOutStart >= UARTBUFFERLENGHT)
-                uart_device[UART_CAM1].bufferOutStart = 0;
-
-            uart_device[UART_CAM1].interruptWhenNoData = 0;
+            uart_statistics_[UART_CAM1].txInterrupts++;
+            UCA1TXBUF = byte;
         }break;
         case USCI_UART_UCSTTIFG: break;
-        case USCI_UART_UCTXCPTIFG: break;
+        case USCI_UART_UCTXCPTIFG:
+        {
+            uart_tx_complete(UART_CAM1);
+            if(uart_device[UART_CAM1].txDrained)
+                UCA1IE &= ~UCTXCPTIE;
+        }break;
     }
 }
 
@@ -637,61 +868,43 @@ __interrupt void USCI_A2_ISR(void)
         case USCI_UART_UCRXIFG:
         {
             UCA2IFG &=~ UCRXIFG;            // Clear interrupt
+            uart_statistics_[UART_CAM2].rxInterrupts++;
 
             //Check RX Overrun flag
             if((UCA2STATW & UCOE) != 0)
-                uart_device[UART_CAM2].counterErrorOverrun++;
+                uart_errors_[UART_CAM2].counterErrorOverrun++;
 
             uint8_t buffer = UCA2RXBUF;
-            uart_device[UART_CAM2].bufferIn[(uart_device[UART_CAM2].bufferInEnd)] = buffer;
-            uart_device[UART_CAM2].bufferInEnd++;
-            if((uart_device[UART_CAM2].bufferInEnd) >= UARTBUFFERLENGHT)
-                uart_device[UART_CAM2].bufferInEnd = 0;
-
-            //Buffer overflow? delete last character
-            if((uart_device[UART_CAM2].bufferInEnd) == (uart_device[UART_CAM2].bufferInStart))
-            {
-                uart_device[UART_CAM2].counterErrorOverflow++;
-                uart_device[UART_CAM2].bufferInStart++;
-            }
-
-
-            if((uart_device[UART_CAM2].bufferInStart) >= UARTBUFFERLENGHT)
-              uart_device[UART_CAM2].bufferInStart = 0;
-
-
-            uart_device[UART_CAM2].somethingOnQueue = 1;
+            //Full: the new byte is lost, the reader owns the old ones
+            if(ring_push(&uart_device[UART_CAM2].rx, buffer) != 0)
+                uart_errors_[UART_CAM2].counterErrorOverflow++;
 
+            //Mirror on the console, sent by the scheduler with the rest
             if(confRegister_.debugUART == 2)
-                UCA0TXBUF = buffer;
+                deferred_push(DEFERRED_UART_MIRROR, buffer);
         }break;
 
         case USCI_UART_UCTXIFG:
         {
-            if((uart_device[UART_CAM2].bufferOutEnd) == (uart_device[UART_CAM2].bufferOutStart))
+            uint8_t byte;
+            if(ring_pop(&uart_device[UART_CAM2].tx, &byte) != 0)
             {
-                //Finish sending, disable TX interrupt and bye bye
-                if((uart_device[UART_CAM2].noDisableTXInterrupt) == 0)
-                    UCA2IE &= ~UCTXIE;
-                else
-                {
-                    UCA2IE &= ~UCTXIE;
-                    uart_device[UART_CAM2].interruptWhenNoData = 1;
-                }
+                //Finish sending, uart_write() enables it again
+                UCA2IE &= ~UCTXIE;
                 break;
             }
 
             //We have to send the next byte in the buffer
-            UCA2TXBUF = uart_device[UART_CAM2].bufferOut[(uart_device[UART_CAM2].bufferOutStart)];
-
-            uart_device[UART_CAM2].bufferOutStart++;
-            if(uart_device[UART_CAM2].bufferOutStart >= UARTBUFFERLENGHT)
-                uart_device[UART_CAM2].bufferOutStart = 0;
-
-            uart_device[UART_CAM2].interruptWhenNoData = 0;
+            uart_statistics_[UART_CAM2].txInterrupts++;
+            UCA2TXBUF = byte;
         }break;
         case USCI_UART_UCSTTIFG: break;
-        case USCI_UART_UCTXCPTIFG: break;
+        case USCI_UART_UCTXCPTIFG:
+        {
+            uart_tx_complete(UART_CAM2);
+            if(uart_device[UART_CAM2].txDrained)
+                UCA2IE &= ~UCTXCPTIE;
+        }break;
     }
 }
 
@@ -713,59 +926,67 @@ __interrupt void USCI_A3_ISR(void)
         case USCI_UART_UCRXIFG:
         {
             UCA3IFG &=~ UCRXIFG;            // Clear interrupt
+            uart_statistics_[uartName].rxInterrupts++;
 
             //Check RX Overrun flag
             if((UCA3STATW & UCOE) != 0)
-                uart_device[uartName].counterErrorOverrun++;
+                uart_errors_[uartName].counterErrorOverrun++;
 
             uint8_t buffer = UCA3RXBUF;
-            uart_device[uartName].bufferIn[(uart_device[uartName].bufferInEnd)] = buffer;
-            uart_device[uartName].bufferInEnd++;
-            if((uart_device[uartName].bufferInEnd) >= UARTBUFFERLENGHT)
-              uart_device[uartName].bufferInEnd = 0;
-
-            //Buffer overflow? delete last character
-            if((uart_device[uartName].bufferInEnd) == (uart_device[uartName].bufferInStart))
-            {
-                uart_device[uartName].counterErrorOverflow++;
-                uart_device[uartName].bufferInStart++;
-            }
-
-            if((uart_device[uartName].bufferInStart) >= UARTBUFFERLENGHT)
-              uart_device[uartName].bufferInStart = 0;
-
-
-            uart_device[uartName].somethingOnQueue = 1;
+            //Full: the new byte is lost, the reader owns the old ones
+            if(ring_push(&uart_device[uartName].rx, buffer) != 0)
+                uart_errors_[uartName].counterErrorOverflow++;
+            //Mirror on the console, sent by the scheduler with the rest
             if(confRegister_.debugUART == uartName)
-                UCA0TXBUF = buffer;
+                deferred_push(DEFERRED_UART_MIRROR, buffer);
         }break;
 
         case USCI_UART_UCTXIFG:
         {
-            if((uart_device[uartName].bufferOutEnd) == (uart_device[uartName].bufferOutStart))
+            uint8_t byte;
+            if(ring_pop(&uart_device[uartName].tx, &byte) != 0)
             {
-                //Finish sending, disable TX interrupt and bye bye
-                if(uart_device[uartName].noDisableTXInterrupt == 0)
-                    UCA3IE &= ~UCTXIE;
-                else
-                {
-                    UCA3IE &= ~UCTXIE;
-                    uart_device[uartName].interruptWhenNoData = 1;
-                }
+                //Finish sending, uart_write() enables it again
+                UCA3IE &= ~UCTXIE;
                 break;
             }
 
             //We have to send the next byte in the buffer
-            UCA3TXBUF = uart_device[uartName].bufferOut[(uart_device[uartName].bufferOutStart)];
-
-            uart_device[uartName].bufferOutStart++;
-            if((uart_device[uartName].bufferOutStart) >= UARTBUFFERLENGHT)
-                uart_device[uartName].bufferOutStart = 0;
-
-            uart_device[uartName].interruptWhenNoData = 0;
+            uart_statistics_[uartName].txInterrupts++;
+            UCA3TXBUF = byte;
         }break;
         case USCI_UART_UCSTTIFG: break;
-        case USCI_UART_UCTXCPTIFG: break;
+        case USCI_UART_UCTXCPTIFG:
+        {
+            //The line is shared, so it is idle for both cameras
+            uart_tx_complete(UART_CAM3);
+            uart_tx_complete(UART_CAM4);
+            if(uart_device[UART_CAM3].txDrained && uart_device[UART_CAM4].txDrained)
+                UCA3IE &= ~UCTXCPTIE;
+        }break;
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/**
+ * Interrupt of the DMA, a block of the UART_DEBUG TX buffer has been sent
+ */
+#pragma vector=DMA_VECTOR
+__interrupt void DMA_ISR(void)
+{
+    switch(__even_in_range(DMAIV, DMAIV_DMA2IFG))
+    {
+        case DMAIV_NONE: break;
+        case DMAIV_DMA0IFG:
+        {
+            //Release the block that has been sent
+            ring_skip(&uart_device[UART_DEBUG].tx, debugDmaLength_);
+            debugDmaLength_ = 0;
+            uart_statistics_[UART_DEBUG].dmaTransfers++;
+
+            //And go for the next one
+            uart_dma_start();
+        }break;
+        default: break;
+    }
+}
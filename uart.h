@@ -9,6 +9,10 @@
 #include <msp430.h>
 #include <stdint.h>
 #include "configuration.h"
+#include "clock.h"
+#include "profiler.h"
+#include "deferred.h"
+#include "ringbuffer.h"
 
 //******************************************************************************
 //* PUBLIC TYPE DEFINITIONS :                                                  *
@@ -18,6 +22,10 @@
 #define BR_38400 1
 #define BR_57600 2
 #define BR_115200 3
+#define BR_230400 4
+#define BR_460800 5
+#define BR_921600 6
+#define BR_COUNT  7
 
 //Base Address (from datasheet)
 #define DEBUG_BASE 0x05C0  //Eusci_A0
@@ -31,13 +39,46 @@
 #define UART_CAM3  3
 #define UART_CAM4  4
 
-#define UARTBUFFERLENGHT 1024
+#define UARTBUFFERLENGHT 1024   //Longest string for uart_print()
+
+// Buffer sizes of every port [bytes], powers of 2. They are placed in the
+// 3784 bytes of LEA RAM, keep the total below that (3072 now).
+#define UART_DEBUG_RX_SIZE  512     //Pasted command lines
+#define UART_DEBUG_TX_SIZE  1024    //Longest uart_print(), dumps wait for room
+#define UART_CAM1_RX_SIZE   256
+#define UART_CAM1_TX_SIZE   128
+#define UART_CAM2_RX_SIZE   256
+#define UART_CAM2_TX_SIZE   128
+#define UART_CAM3_RX_SIZE   256
+#define UART_CAM3_TX_SIZE   128
+#define UART_CAM4_RX_SIZE   256
+#define UART_CAM4_TX_SIZE   128
+
+#define UART_MUX_HOLD   100     //[ms] Min time CAM3/CAM4 keep the mux after writing
+
+//Counters to measure the load of the UART engine
+struct UartStatistics
+{
+    uint32_t rxInterrupts;      //Bytes received by interrupt
+    uint32_t txInterrupts;      //Bytes sent by interrupt
+    uint32_t dmaTransfers;      //DMA blocks sent (only UART_DEBUG)
+    uint32_t txBufferFull;      //Times the writer waited for a full TX buffer
+    uint16_t overrunErrors;     //Bytes lost in the eUSCI, kept across resets
+    uint16_t overflowErrors;    //Bytes lost with the RX buffer full, same
+};
 
 
 //******************************************************************************
 //* PUBLIC FUNCTION DECLARATIONS :                                             *
 //******************************************************************************
 int8_t uart_init(uint8_t uart_name, uint8_t baudrate);
+int8_t uart_set_baudrate(uint8_t uart_name, uint8_t baudrate);
+uint8_t uart_get_baudrate(uint8_t uart_name);
+uint32_t uart_baudrate_value(uint8_t baudrate);
+uint8_t uart_baudrate_supported(uint8_t profile, uint8_t baudrate);
+uint8_t uart_retime(void);
+uint8_t uart_check_baudrate(uint8_t uart_name);
+uint8_t uart_isOpen(uint8_t uart_name);
 void uart_close(uint8_t uart_name);
 
 int8_t uart_write(uint8_t uart_name,
@@ -51,8 +92,14 @@ uint8_t uart_read(uint8_t uart_name);
 
 int16_t uart_available(uint8_t uart_name);
 int16_t uart_tx_onWait(uint8_t uart_name);
+uint8_t uart_tx_isDrained(uint8_t uart_name);
+uint32_t uart_tx_drainedAt(uint8_t uart_name);
 void uart_flush(uint8_t uart_name);
 void uart_clear_buffer(uint8_t uart_name);
+void uart_get_statistics(uint8_t uart_name, struct UartStatistics *statistics);
+int8_t uart_mux_request(uint8_t uart_name, uint16_t holdTime);
+void uart_mux_release(uint8_t uart_name);
+void uart_mux_service(void);
 
 
 #endif /* UART_H_ */